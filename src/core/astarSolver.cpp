@@ -0,0 +1,112 @@
+#include "solver.h"
+#include "deadlock.h"
+#include "heuristic.h"
+#include "macros.h"
+#include "nodeStore.h"
+
+#include <queue>
+
+namespace {
+    struct OpenEntry {
+        uint32_t f;
+        uint16_t g;
+        uint32_t index;
+
+        // std::priority_queue pops the largest element: lowest f first, deeper nodes first on ties
+        bool operator<(const OpenEntry &other) const {
+            return f != other.f ? f > other.f : g < other.g;
+        }
+    };
+}
+
+SolverResult solveAStar(const Level &level, const SolverOptions &options) {
+    SolverResult result;
+    SearchBudget budget(options);
+
+    const Bitboard &dead = level.dead;
+    const PushDistances distances(level);
+    const MacroMoves macros(level, options.macros);
+    const double weight = options.weight < 1.0 ? 1.0 : options.weight;
+
+    // heuristic with its cost measured, so it can be tuned against the nodes it saves
+    auto estimate = [&](const Bitboard &boxes) {
+        auto start = std::chrono::steady_clock::now();
+        const int h = distances.lowerBound(boxes);
+        result.heuristicMilliseconds +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        ++result.heuristicCalls;
+        return h;
+    };
+    auto priority = [weight](int g, int h) { return (uint32_t)(g + (int)(weight * h)); };
+
+    NodeStore nodes;
+    std::vector<uint8_t> closed;
+    std::priority_queue<OpenEntry> open;
+
+    const int rootH = estimate(level.boxes);
+    if (rootH == PushDistances::UNREACHABLE) {
+        result.unsolvable = true;
+        return result;
+    }
+    nodes.insert(rootNode(level));
+    closed.push_back(0);
+    std::vector<uint16_t> estimates {(uint16_t)rootH};
+    // the box each push moved last, for the corral test when the node is expanded (the root has none)
+    std::vector<uint8_t> movedBox {0};
+    open.push({priority(0, rootH), 0, 0});
+    result.generated = 1;
+
+    while (!open.empty()) {
+        if (budget.exceeded(nodes.size()))
+            return result;
+        const OpenEntry entry = open.top();
+        open.pop();
+        // entries are not removed when a node is reached by a shorter path, skip the outdated ones
+        if (closed[entry.index] || entry.g != nodes[entry.index].depth)
+            continue;
+        const SearchNode parent = nodes[entry.index];
+        if (estimates[entry.index] == 0) {
+            result.solved = true;
+            result.pushes = macros.expand(nodes.pushesTo(entry.index));
+            return result;
+        }
+        closed[entry.index] = 1;
+        const Bitboard reach = reachable(level, parent.boxes, parent.player);
+        // the corral sub-search waits until the node is expanded, most generated nodes never are
+        if (entry.index > 0 && isCorralDeadlock(level, parent.boxes, movedBox[entry.index], reach))
+            continue;
+        ++result.expanded;
+
+        forEachPush(level, parent.boxes, reach, [&](const Push &push) {
+            if (dead.test(push.box + level.offset(push.dir)))
+                return;
+            const SearchNode child = macros.child(parent, entry.index, push);
+            auto inserted = nodes.insert(child);
+            if (inserted.second) {
+                const int h = estimate(child.boxes);
+                // the box that moved, which a macro move may have pushed further than one tile
+                const int moved = child.boxes.andNot(parent.boxes).first();
+                closed.push_back(0);
+                estimates.push_back((uint16_t)h);
+                movedBox.push_back((uint8_t)moved);
+                ++result.generated;
+                if (h != PushDistances::UNREACHABLE && !isLocalDeadlock(level, child.boxes, moved))
+                    open.push({priority(child.depth, h), child.depth, inserted.first});
+                else
+                    closed.back() = 1; // deadlock, never expand
+                return;
+            }
+            // already known: keep the shorter path if the node has not been expanded yet
+            SearchNode &known = nodes[inserted.first];
+            if (!closed[inserted.first] && child.depth < known.depth) {
+                known.parent = child.parent;
+                known.pushBox = child.pushBox;
+                known.pushDir = child.pushDir;
+                known.depth = child.depth;
+                open.push({priority(child.depth, estimates[inserted.first]), child.depth, inserted.first});
+            }
+        });
+    }
+    result.unsolvable = true;
+    return result;
+}
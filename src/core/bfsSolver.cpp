@@ -0,0 +1,66 @@
+#include "solver.h"
+#include "deadlock.h"
+#include "macros.h"
+#include "nodeStore.h"
+
+SolverResult solveBfs(const Level &level, const SolverOptions &options) {
+    SolverResult result;
+    SearchBudget budget(options);
+
+    // a box pushed onto a dead square can never be solved, so those pushes are not generated
+    const Bitboard &dead = level.dead;
+    const MacroMoves macros(level, options.macros);
+
+    NodeStore nodes;
+    nodes.insert(rootNode(level));
+    // deadlocked states stay in the store, so reaching them again is rejected as a duplicate, but are not expanded
+    std::vector<uint8_t> deadlocked {0};
+    // the box each push moved last, for the corral test when the node is expanded (the root has none)
+    std::vector<uint8_t> movedBox {0};
+    result.generated = 1;
+
+    if (level.boxes.andNot(level.targets).none()) {
+        result.solved = true;
+        return result;
+    }
+
+    // the store is also the FIFO queue: everything after head is the frontier, in push order
+    for (uint32_t head {0}; head < nodes.size(); ++head) {
+        if (budget.exceeded(nodes.size()))
+            return result;
+        if (deadlocked[head])
+            continue;
+        const SearchNode parent = nodes[head];
+        const Bitboard reach = reachable(level, parent.boxes, parent.player);
+        // The corral sub-search is the one expensive test, so it waits until the node is expanded: the region is
+        // needed here anyway, and the last layer (most of the nodes) is never expanded at all.
+        if (head > 0 && isCorralDeadlock(level, parent.boxes, movedBox[head], reach))
+            continue;
+        ++result.expanded;
+
+        bool found = false;
+        forEachPush(level, parent.boxes, reach, [&](const Push &push) {
+            if (found || dead.test(push.box + level.offset(push.dir)))
+                return;
+            auto inserted = nodes.insert(macros.child(parent, head, push));
+            if (!inserted.second)
+                return;
+            ++result.generated;
+            const SearchNode &child = nodes[inserted.first];
+            if (child.boxes.andNot(level.targets).none()) {
+                result.pushes = macros.expand(nodes.pushesTo(inserted.first));
+                found = true;
+            }
+            // the box that moved, which a macro move may have pushed further than one tile
+            const int moved = child.boxes.andNot(parent.boxes).first();
+            deadlocked.push_back(!found && isLocalDeadlock(level, child.boxes, moved));
+            movedBox.push_back((uint8_t)moved);
+        });
+        if (found) {
+            result.solved = true;
+            return result;
+        }
+    }
+    result.unsolvable = true;
+    return result;
+}
@@ -0,0 +1,177 @@
+#include "solver.h"
+#include "deadlock.h"
+#include "nodeStore.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <climits>
+
+// Breadth-first from the start (pushes) and from the solved position (pulls) at once, always growing the smaller
+// frontier by one layer. Both searches share one node store, so a state created by one side that the other side
+// already holds is where they meet. The first layer with a meeting is finished and the shortest meeting kept,
+// which makes the solution push-optimal like plain BFS.
+//
+// Backward nodes store the push that leads from them to their parent, so the second half of the solution is read
+// by walking parents from the meeting point to the solved position.
+
+namespace {
+    // cells a box can be pushed onto from where it starts, ignoring the other boxes; a pull never needs to put a
+    // box anywhere else
+    Bitboard boxReach(const Level &level) {
+        Bitboard seen = level.boxes;
+        int queue[MAX_CELLS];
+        int head = 0, tail = 0;
+        level.boxes.forEach([&](int box) { queue[tail++] = box; });
+        while (head < tail) {
+            const int cell = queue[head++];
+            for (int d {0}; d < 4; ++d) {
+                const int delta = level.offset(static_cast<Direction>(d));
+                const int to = cell + delta;
+                if (!level.isWall(cell - delta) && !level.isWall(to) && !seen.test(to)) {
+                    seen.set(to);
+                    queue[tail++] = to;
+                }
+            }
+        }
+        return seen;
+    }
+
+    // where the two searches met: the forward path to forward, then link, then the backward path from backward
+    struct Meeting {
+        uint32_t forward;
+        Push link;
+        uint32_t backward;
+        int forwardDepth, backwardDepth;
+    };
+}
+
+SolverResult solveBidirectional(const Level &level, const SolverOptions &options) {
+    SolverResult result;
+    SearchBudget budget(options);
+
+    if (level.boxes.andNot(level.targets).none()) {
+        result.solved = true;
+        return result;
+    }
+    // with spare targets there is no single solved position to start from
+    if (level.boxes.count() != level.targets.count())
+        return solveBfs(level, options);
+
+    const Bitboard pullable = boxReach(level);
+
+    NodeStore nodes;
+    std::vector<uint8_t> backward;     // by node: which side created it
+    std::vector<uint32_t> frontier[2];
+
+    // roots are their own parent
+    nodes.insert(rootNode(level));
+    backward.push_back(0);
+    frontier[0].push_back(0);
+
+    // the solved boxes with the player in each region they leave open
+    Bitboard covered = level.walls | level.targets;
+    for (int cell {0}; cell < level.cellCount(); ++cell) {
+        if (covered.test(cell))
+            continue;
+        const Bitboard region = reachable(level, level.targets, cell);
+        covered |= region;
+        SearchNode root {};
+        root.boxes = level.targets;
+        root.boxHash = zobristBoxes(root.boxes);
+        root.player = (uint16_t)region.first();
+        root.hash = root.boxHash ^ ZOBRIST.player[root.player];
+        auto inserted = nodes.insert(root);
+        nodes[inserted.first].parent = inserted.first;
+        backward.push_back(1);
+        frontier[1].push_back(inserted.first);
+    }
+    result.generated = nodes.size();
+
+    Meeting best {0, {0, Direction::Up}, 0, INT_MAX / 2, INT_MAX / 2};
+    while (!frontier[0].empty() && !frontier[1].empty()) {
+        const int side = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        std::vector<uint32_t> next;
+
+        for (uint32_t index : frontier[side]) {
+            if (budget.exceeded(nodes.size())) {
+                result.generated = nodes.size();
+                return result;
+            }
+            ++result.expanded;
+            const SearchNode parent = nodes[index];
+            const Bitboard reach = reachable(level, parent.boxes, parent.player);
+
+            auto visit = [&](const SearchNode &child, int to) {
+                auto inserted = nodes.insert(child);
+                if (inserted.second) {
+                    backward.push_back((uint8_t)side);
+                    // a deadlocked position can never reach the solved one, only the forward side creates them
+                    if (side == 0 && isDeadlockAfterPush(level, child.boxes, to,
+                                                         reachable(level, child.boxes, child.player)))
+                        return;
+                    next.push_back(inserted.first);
+                    return;
+                }
+                if (backward[inserted.first] == side)
+                    return;
+                const SearchNode &other = nodes[inserted.first];
+                const Push link {child.pushBox, child.pushDir};
+                const Meeting meeting = side == 0
+                    ? Meeting {index, link, inserted.first, parent.depth + 1, other.depth}
+                    : Meeting {inserted.first, link, index, other.depth, parent.depth + 1};
+                if (meeting.forwardDepth + meeting.backwardDepth < best.forwardDepth + best.backwardDepth)
+                    best = meeting;
+            };
+
+            if (side == 0) {
+                forEachPush(level, parent.boxes, reach, [&](const Push &push) {
+                    const int to = push.box + level.offset(push.dir);
+                    if (!level.isDead(to))
+                        visit(childNode(level, parent, index, push), to);
+                });
+                continue;
+            }
+            // pulls: the player next to a box steps away from it and drags it along, which undoes a push in dir
+            const Bitboard blocked = level.walls | parent.boxes;
+            parent.boxes.forEach([&](int box) {
+                for (int d {0}; d < 4; ++d) {
+                    const auto dir = static_cast<Direction>(d);
+                    const int delta = level.offset(dir);
+                    const int from = box - delta, behind = from - delta;
+                    if (!reach.test(from) || blocked.test(behind) || !pullable.test(from))
+                        continue;
+                    SearchNode child {};
+                    child.boxes = parent.boxes;
+                    child.boxes.move(box, from);
+                    child.player = (uint16_t)normalizedPlayer(level, child.boxes, behind);
+                    child.boxHash = parent.boxHash ^ ZOBRIST.box[box] ^ ZOBRIST.box[from];
+                    child.hash = child.boxHash ^ ZOBRIST.player[child.player];
+                    child.parent = index;
+                    child.pushBox = (uint16_t)from;
+                    child.pushDir = dir;
+                    child.depth = (uint16_t)(parent.depth + 1);
+                    visit(child, from);
+                }
+            });
+        }
+        frontier[side].swap(next);
+        if (best.forwardDepth + best.backwardDepth < INT_MAX / 2)
+            break;
+    }
+    result.generated = nodes.size();
+    if (best.forwardDepth + best.backwardDepth >= INT_MAX / 2) {
+        result.unsolvable = true;
+        return result;
+    }
+
+    result.solved = true;
+    result.forwardDepth = best.forwardDepth;
+    result.backwardDepth = best.backwardDepth;
+    for (uint32_t i = best.forward; nodes[i].parent != i; i = nodes[i].parent)
+        result.pushes.push_back({nodes[i].pushBox, nodes[i].pushDir});
+    std::reverse(result.pushes.begin(), result.pushes.end());
+    result.pushes.push_back(best.link);
+    for (uint32_t i = best.backward; nodes[i].parent != i; i = nodes[i].parent)
+        result.pushes.push_back({nodes[i].pushBox, nodes[i].pushDir});
+    return result;
+}
@@ -0,0 +1,130 @@
+#ifndef SOKOBAN_BITBOARD_H
+#define SOKOBAN_BITBOARD_H
+
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// @brief Number of 64-bit words in a Bitboard.
+/// @details 4 words hold a 16x16 padded grid, which covers every map in res/maps.txt (12x12 + the wall ring).
+constexpr int BOARD_WORDS = 4;
+
+/// @brief Largest padded level (width * height) a Bitboard can describe.
+constexpr int MAX_CELLS = BOARD_WORDS * 64;
+
+inline int popcount64(uint64_t w) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(w);
+#else
+    return __builtin_popcountll(w);
+#endif
+}
+
+/// @brief Index of the lowest set bit, w must not be 0.
+inline int ctz64(uint64_t w) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, w);
+    return (int)idx;
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+/**
+ * @brief A set of cells, one bit per cell index of a Level.
+ * @details Used for walls, targets and boxes so rule checks are a few word-wide mask operations instead of
+ *          scans over the grid.
+ */
+struct Bitboard {
+    uint64_t words[BOARD_WORDS] {};
+
+    bool test(int cell) const { return (words[cell >> 6] >> (cell & 63)) & 1; }
+    void set(int cell)        { words[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void reset(int cell)      { words[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+
+    /// @brief Moves a bit from one cell to another (from must be set and to must be clear).
+    void move(int from, int to) {
+        reset(from);
+        set(to);
+    }
+
+    bool none() const {
+        uint64_t acc = 0;
+        for (uint64_t w : words) acc |= w;
+        return acc == 0;
+    }
+    bool any() const { return !none(); }
+
+    int count() const {
+        int n = 0;
+        for (uint64_t w : words) n += popcount64(w);
+        return n;
+    }
+
+    /// @brief count (at most 64) consecutive cells starting at start, the first one in the lowest bit.
+    uint64_t bits(int start, int count) const {
+        const int word = start >> 6, offset = start & 63;
+        uint64_t value = words[word] >> offset;
+        if (offset + count > 64 && offset != 0 && word + 1 < BOARD_WORDS)
+            value |= words[word + 1] << (64 - offset);
+        return count == 64 ? value : value & ((uint64_t(1) << count) - 1);
+    }
+
+    /// @brief Index of the lowest set cell, or -1 if the set is empty.
+    int first() const {
+        for (int i {0}; i < BOARD_WORDS; ++i)
+            if (words[i]) return i * 64 + ctz64(words[i]);
+        return -1;
+    }
+
+    /// @brief Calls f(cell) for every set cell in ascending order.
+    template <typename F>
+    void forEach(F f) const {
+        for (int i {0}; i < BOARD_WORDS; ++i) {
+            for (uint64_t w = words[i]; w; w &= w - 1)
+                f(i * 64 + ctz64(w));
+        }
+    }
+
+    /// @brief this & ~other
+    Bitboard andNot(const Bitboard &other) const {
+        Bitboard r;
+        for (int i {0}; i < BOARD_WORDS; ++i) r.words[i] = words[i] & ~other.words[i];
+        return r;
+    }
+
+    Bitboard operator&(const Bitboard &other) const {
+        Bitboard r;
+        for (int i {0}; i < BOARD_WORDS; ++i) r.words[i] = words[i] & other.words[i];
+        return r;
+    }
+    Bitboard operator|(const Bitboard &other) const {
+        Bitboard r;
+        for (int i {0}; i < BOARD_WORDS; ++i) r.words[i] = words[i] | other.words[i];
+        return r;
+    }
+    Bitboard operator^(const Bitboard &other) const {
+        Bitboard r;
+        for (int i {0}; i < BOARD_WORDS; ++i) r.words[i] = words[i] ^ other.words[i];
+        return r;
+    }
+    Bitboard &operator|=(const Bitboard &other) {
+        for (int i {0}; i < BOARD_WORDS; ++i) words[i] |= other.words[i];
+        return *this;
+    }
+    Bitboard &operator&=(const Bitboard &other) {
+        for (int i {0}; i < BOARD_WORDS; ++i) words[i] &= other.words[i];
+        return *this;
+    }
+
+    bool operator==(const Bitboard &other) const {
+        uint64_t diff = 0;
+        for (int i {0}; i < BOARD_WORDS; ++i) diff |= words[i] ^ other.words[i];
+        return diff == 0;
+    }
+    bool operator!=(const Bitboard &other) const { return !(*this == other); }
+};
+
+#endif //SOKOBAN_BITBOARD_H
@@ -0,0 +1,255 @@
+#include "compiledPack.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+using std::string, std::vector, std::cout, std::endl;
+
+namespace {
+    const char PACK_MAGIC[4] = {'S', 'K', 'L', 'P'};
+    const uint32_t PACK_VERSION = 3;
+    const size_t HEADER_SIZE = 40;
+    // offset of the source modification time in the header
+    const size_t SOURCE_TIME = 32;
+    const size_t INDEX_ENTRY_SIZE = 16;
+
+    // bitplanes per record
+    const int PLANES = 7;
+    const size_t RECORD_SIZE = 16 + PLANES * BOARD_WORDS * sizeof(uint64_t);
+
+    // Fields are copied in place: the file is little endian like every platform the game builds for, and
+    // memcpy keeps the reads legal whatever the alignment.
+    template<typename T>
+    T read(const char *in) {
+        T value;
+        memcpy(&value, in, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void append(string &out, T value) {
+        out.append((const char *)&value, sizeof(T));
+    }
+
+    // FNV-1a over the bytes of the source text
+    uint64_t hashText(const string &text) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : text) {
+            hash ^= (unsigned char)c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // size and modification time of a file, the time in ticks of the filesystem clock (only ever compared with
+    // another time taken on the same machine)
+    bool statFile(const string &path, uint64_t &size, int64_t &time) {
+        std::error_code error;
+        size = std::filesystem::file_size(path, error);
+        if (error)
+            return false;
+        time = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+        return !error;
+    }
+
+    bool readFile(const string &path, string &text) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // the bitplanes of a level in file order, for a Level or a const Level
+    template<typename L>
+    std::array<decltype(&std::declval<L &>().walls), PLANES> planesOf(L &level) {
+        return {&level.walls, &level.targets, &level.boxes, &level.dead,
+                &level.tunnels[0], &level.tunnels[1], &level.goalRoom};
+    }
+}
+
+void CompiledPack::close() {
+    file.close();
+    filePath.clear();
+    count = 0;
+}
+
+bool CompiledPack::open(const std::string &path) {
+    close();
+    if (!file.open(path)) {
+        cout << "could not open " << path << endl;
+        return false;
+    }
+    const char *data = file.data();
+    if (file.size() < HEADER_SIZE || memcmp(data, PACK_MAGIC, 4) != 0) {
+        cout << path << " is not a compiled level pack" << endl;
+        close();
+        return false;
+    }
+    if (read<uint32_t>(data + 4) != PACK_VERSION) {
+        cout << path << " was compiled by another version, run sokoban-levelc again" << endl;
+        close();
+        return false;
+    }
+    if (read<uint32_t>(data + 12) != (uint32_t)BOARD_WORDS) {
+        cout << path << " was compiled for another board size, run sokoban-levelc again" << endl;
+        close();
+        return false;
+    }
+    const uint32_t levels = read<uint32_t>(data + 8);
+    if (file.size() < HEADER_SIZE + (size_t)levels * INDEX_ENTRY_SIZE) {
+        cout << path << " is truncated" << endl;
+        close();
+        return false;
+    }
+    count = levels;
+    filePath = path;
+    return true;
+}
+
+int CompiledPack::id(int index) const {
+    return read<int32_t>(file.data() + HEADER_SIZE + (size_t)index * INDEX_ENTRY_SIZE);
+}
+
+std::string CompiledPack::title(int index) const {
+    const char *entry = file.data() + HEADER_SIZE + (size_t)index * INDEX_ENTRY_SIZE;
+    const uint32_t offset = read<uint32_t>(entry + 8), length = read<uint32_t>(entry + 12);
+    if ((size_t)offset + length > file.size())
+        return string();
+    return string(file.data() + offset, length);
+}
+
+int CompiledPack::find(int id) const {
+    int low = 0, high = (int)count;
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        if (this->id(middle) < id)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low < (int)count && this->id(low) == id ? low : -1;
+}
+
+bool CompiledPack::load(int index, Level &level) const {
+    const char *entry = file.data() + HEADER_SIZE + (size_t)index * INDEX_ENTRY_SIZE;
+    const uint32_t offset = read<uint32_t>(entry + 4);
+    if ((size_t)offset + RECORD_SIZE > file.size()) {
+        cout << "level " << read<int32_t>(entry) << " lies outside the compiled pack" << endl;
+        return false;
+    }
+    const char *record = file.data() + offset;
+    level = Level();
+    level.id = read<int32_t>(entry);
+    level.rows = read<uint16_t>(record);
+    level.cols = read<uint16_t>(record + 2);
+    level.width = read<uint16_t>(record + 4);
+    level.height = read<uint16_t>(record + 6);
+    level.playerStart = read<int32_t>(record + 8);
+    level.goalEntrance = read<int32_t>(record + 12);
+    const char *planes = record + 16;
+    for (Bitboard *plane : planesOf(level)) {
+        memcpy(plane->words, planes, sizeof(plane->words));
+        planes += sizeof(plane->words);
+    }
+    return true;
+}
+
+bool CompiledPack::compiledFrom(const std::string &sourcePath) const {
+    uint64_t size;
+    int64_t time;
+    if (file.size() < HEADER_SIZE || !statFile(sourcePath, size, time) || read<uint64_t>(file.data() + 16) != size)
+        return false;
+    if (read<int64_t>(file.data() + SOURCE_TIME) == time)
+        return true;
+    string text;
+    if (!readFile(sourcePath, text) || text.size() != size || read<uint64_t>(file.data() + 24) != hashText(text))
+        return false;
+    // same text, new time: record it so the next start only needs the stat (a read-only pack is hashed each time)
+    std::fstream out(filePath, std::ios::in | std::ios::out | std::ios::binary);
+    out.seekp(SOURCE_TIME);
+    out.write((const char *)&time, sizeof(time));
+    return true;
+}
+
+bool CompiledPack::write(const std::string &path, const std::vector<Level> &levels,
+                         const std::vector<std::string> &titles, const std::string &sourcePath) {
+    // stat before reading, so a save in between leaves a time that does not match and the text is checked
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    string source;
+    if (!statFile(sourcePath, sourceSize, sourceTime) || !readFile(sourcePath, source)) {
+        cout << "could not read " << sourcePath << endl;
+        return false;
+    }
+    vector<size_t> order(levels.size());
+    for (size_t i {0}; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return levels[a].id < levels[b].id; });
+    for (size_t i {1}; i < order.size(); ++i) {
+        if (levels[order[i]].id == levels[order[i - 1]].id) {
+            cout << "level " << levels[order[i]].id << " appears twice" << endl;
+            return false;
+        }
+    }
+
+    const size_t recordsStart = HEADER_SIZE + levels.size() * INDEX_ENTRY_SIZE;
+    size_t titleOffset = recordsStart + levels.size() * RECORD_SIZE;
+    string out;
+    out.append(PACK_MAGIC, 4);
+    append<uint32_t>(out, PACK_VERSION);
+    append<uint32_t>(out, (uint32_t)levels.size());
+    append<uint32_t>(out, (uint32_t)BOARD_WORDS);
+    append<uint64_t>(out, (uint64_t)source.size());
+    append<uint64_t>(out, hashText(source));
+    append<int64_t>(out, sourceTime);
+    for (size_t i {0}; i < order.size(); ++i) {
+        const size_t title = order[i] < titles.size() ? titles[order[i]].size() : 0;
+        append<int32_t>(out, levels[order[i]].id);
+        append<uint32_t>(out, (uint32_t)(recordsStart + i * RECORD_SIZE));
+        append<uint32_t>(out, (uint32_t)titleOffset);
+        append<uint32_t>(out, (uint32_t)title);
+        titleOffset += title;
+    }
+    for (size_t i : order) {
+        const Level &level = levels[i];
+        append<uint16_t>(out, (uint16_t)level.rows);
+        append<uint16_t>(out, (uint16_t)level.cols);
+        append<uint16_t>(out, (uint16_t)level.width);
+        append<uint16_t>(out, (uint16_t)level.height);
+        append<int32_t>(out, level.playerStart);
+        append<int32_t>(out, level.goalEntrance);
+        for (const Bitboard *plane : planesOf(level)) {
+            for (uint64_t word : plane->words)
+                append<uint64_t>(out, word);
+        }
+    }
+    for (size_t i : order) {
+        if (i < titles.size())
+            out += titles[i];
+    }
+    if (titleOffset > UINT32_MAX) {
+        cout << "too many levels for one compiled pack" << endl;
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        cout << "could not write " << path << endl;
+        return false;
+    }
+    file.write(out.data(), (std::streamsize)out.size());
+    return (bool)file;
+}
+
+bool CompiledPack::isCompiled(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4] = {};
+    return in.read(magic, 4) && memcmp(magic, PACK_MAGIC, 4) == 0;
+}
@@ -0,0 +1,72 @@
+#ifndef SOKOBAN_COMPILED_PACK_H
+#define SOKOBAN_COMPILED_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "level.h"
+#include "mappedFile.h"
+
+/**
+ * @brief The CompiledPack class.
+ * @details A level pack compiled by sokoban-levelc, read in place from a memory mapped file: opening it only
+ *          checks the header, and loading a level copies its record into a Level, so both cost the same whatever
+ *          the size of the pack. Layout, little endian, sections 8-byte aligned:
+ *
+ *          - header: "SKLP", u32 version (3), u32 level count, u32 BOARD_WORDS of the compiler, u64 size, u64
+ *            FNV-1a hash and i64 modification time of the text the pack was compiled from
+ *          - index, one entry per level sorted by id: i32 id, u32 record offset, u32 title offset, u32 title length
+ *          - records: u16 rows, cols, width, height, i32 player start, i32 goal entrance, then the bitplanes walls,
+ *            targets, boxes, dead, tunnels[0], tunnels[1] and goalRoom, BOARD_WORDS u64 each
+ *          - titles, UTF-8 without terminators
+ *
+ *          Records hold everything parseLevel() derives from a level (dead squares, tunnels, goal room), so
+ *          nothing is computed on load either. A pack compiled with another BOARD_WORDS is rejected.
+ */
+class CompiledPack {
+public:
+    /// @brief Maps a compiled pack, replacing the one currently open.
+    /// @return false (and an empty pack) if the file is missing or not a compiled pack
+    bool open(const std::string &path);
+
+    void close();
+
+    int size() const { return (int)count; }
+    bool empty() const { return count == 0; }
+
+    /// @brief Id and title of the level at index. Levels are in order of id.
+    int id(int index) const;
+    std::string title(int index) const;
+
+    /// @brief Binary search of the index.
+    /// @return the index of the level with this id, -1 if there is none
+    int find(int id) const;
+
+    /// @return false if the record lies outside the file
+    bool load(int index, Level &level) const;
+
+    /// @brief Whether the pack was compiled from the file at sourcePath as it is now.
+    /// @details A stat first: if the size and modification time recorded in the header still match, the text is not
+    ///          read. Otherwise (an edit, but also a checkout or a copy, which change only the time) the text is read
+    ///          and compared by size and hash, and on a match its new time is written into the header so the next
+    ///          check is a stat again.
+    bool compiledFrom(const std::string &sourcePath) const;
+
+    /// @brief Writes levels as a compiled pack, sorted by id. titles[i] belongs to levels[i], sourcePath is the file
+    ///        they were compiled from (see compiledFrom()).
+    /// @return false if a file could not be read or written or two levels share an id
+    static bool write(const std::string &path, const std::vector<Level> &levels,
+                      const std::vector<std::string> &titles, const std::string &sourcePath);
+
+    /// @brief True if the file starts like a compiled pack.
+    static bool isCompiled(const std::string &path);
+
+private:
+    MappedFile file;
+    std::string filePath;
+    uint32_t count {0};
+};
+
+#endif //SOKOBAN_COMPILED_PACK_H
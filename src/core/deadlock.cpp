@@ -0,0 +1,114 @@
+#include "deadlock.h"
+#include "patternDatabase.h"
+#include "search.h"
+#include "zobrist.h"
+
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    // larger corrals are left to the solver, their sub-search would rarely finish within budget
+    const int MAX_CORRAL_BOXES = 6;
+
+    bool frozen(const Level &level, const Bitboard &boxes, int cell, Bitboard &fixed);
+
+    // true if the box on cell can never move along the axis of delta
+    bool blocked(const Level &level, const Bitboard &boxes, int cell, int delta, Bitboard &fixed) {
+        const int a = cell - delta, b = cell + delta;
+        if (level.isWall(a) || level.isWall(b) || fixed.test(a) || fixed.test(b))
+            return true;
+        if (level.isDead(a) && level.isDead(b))
+            return true;
+        return (boxes.test(a) && frozen(level, boxes, a, fixed)) || (boxes.test(b) && frozen(level, boxes, b, fixed));
+    }
+
+    // fixed holds the boxes assumed immovable: the ones proven frozen and the ones being checked, which breaks
+    // cycles. If cell turns out to be movable, everything assumed while checking it is taken back.
+    bool frozen(const Level &level, const Bitboard &boxes, int cell, Bitboard &fixed) {
+        const Bitboard before = fixed;
+        fixed.set(cell);
+        if (blocked(level, boxes, cell, 1, fixed) && blocked(level, boxes, cell, level.width, fixed))
+            return true;
+        fixed = before;
+        return false;
+    }
+
+    struct CorralState {
+        Bitboard boxes;
+        uint64_t hash;
+        int player;     // normalized
+
+        bool operator==(const CorralState &other) const {
+            return player == other.player && boxes == other.boxes;
+        }
+    };
+
+    struct CorralStateHash {
+        size_t operator()(const CorralState &state) const { return (size_t)state.hash; }
+    };
+}
+
+bool isFreezeDeadlock(const Level &level, const Bitboard &boxes, int box) {
+    Bitboard fixed;
+    if (!frozen(level, boxes, box, fixed))
+        return false;
+    return (fixed & boxes).andNot(level.targets).any();
+}
+
+bool isCorralDeadlock(const Level &level, const Bitboard &boxes, int box, const Bitboard &reach, size_t maxStates) {
+    // the area the player cannot reach that the box is part of, boxes included: a flood fill from the box with
+    // the player's region as the obstacles
+    const Bitboard area = reachable(level, reach, box);
+    const Bitboard inside = area.andNot(boxes);
+    const Bitboard corral = area & boxes;
+    // a group of boxes without floor behind it is not a corral, the freeze test covers that
+    if (inside.none() || corral.count() > MAX_CORRAL_BOXES || corral.andNot(level.targets).none())
+        return false;
+
+    // breadth-first over pushes of the corral boxes alone
+    std::vector<CorralState> states;
+    std::unordered_set<CorralState, CorralStateHash> seen;
+    auto add = [&](const Bitboard &subBoxes, int player) {
+        const int normalized = normalizedPlayer(level, subBoxes, player);
+        CorralState state {subBoxes, zobristHash(subBoxes, normalized), normalized};
+        if (seen.insert(state).second)
+            states.push_back(state);
+    };
+    add(corral, reach.first());
+
+    for (size_t next {0}; next < states.size(); ++next) {
+        if (states.size() > maxStates)
+            return false;
+        const CorralState state = states[next];
+        const Bitboard subReach = reachable(level, state.boxes, state.player);
+        // the player got in: the fence can be opened, nothing is proven
+        if ((subReach & inside).andNot(state.boxes).any())
+            return false;
+        bool solved = false;
+        forEachPush(level, state.boxes, subReach, [&](const Push &push) {
+            const int to = push.box + level.offset(push.dir);
+            if (solved || level.isDead(to))
+                return;
+            Bitboard child = state.boxes;
+            child.move(push.box, to);
+            if (child.andNot(level.targets).none()) {
+                solved = true;
+                return;
+            }
+            if (!isFreezeDeadlock(level, child, to))
+                add(child, push.box);
+        });
+        if (solved)
+            return false;
+    }
+    return true;
+}
+
+bool isLocalDeadlock(const Level &level, const Bitboard &boxes, int box) {
+    return isFreezeDeadlock(level, boxes, box) || deadlockPatterns().isDeadlock(level, boxes, box);
+}
+
+bool isDeadlockAfterPush(const Level &level, const Bitboard &boxes, int box, const Bitboard &reach,
+                         size_t corralStates) {
+    return isLocalDeadlock(level, boxes, box) || isCorralDeadlock(level, boxes, box, reach, corralStates);
+}
@@ -0,0 +1,42 @@
+#ifndef SOKOBAN_DEADLOCK_H
+#define SOKOBAN_DEADLOCK_H
+
+#include <cstddef>
+
+#include "level.h"
+
+// Deadlock tests that go beyond dead squares (Level::dead). All of them are local to the box that was just pushed,
+// so they can run after every push, in the game as well as in the solvers. They only report a deadlock when it is
+// proven: a false answer means "not found", never "solvable".
+
+/// @brief States the corral test may explore before it gives up, see isCorralDeadlock().
+const size_t CORRAL_STATES = 256;
+
+/// @brief Freeze deadlock around the box on cell box.
+/// @details A box is frozen when it is blocked along both axes, by walls, by a pair of dead squares or by boxes
+///          that are frozen themselves. The level is lost when a group of frozen boxes includes one that is not
+///          on a target. Only the boxes touching the group of box are looked at.
+bool isFreezeDeadlock(const Level &level, const Bitboard &boxes, int box);
+
+/// @brief Corral deadlock around the box on cell box.
+/// @details A corral is floor the player cannot reach, fenced in by boxes. When the box touches one, the boxes of
+///          the corral are solved on their own with every other box removed, which only makes the level easier:
+///          if they can neither all reach targets nor open the corral to the player, the level is lost.
+///          Corrals with many boxes, and searches that need more than maxStates states, are not reported.
+/// @param reach Cells the player can walk to in this position
+bool isCorralDeadlock(const Level &level, const Bitboard &boxes, int box, const Bitboard &reach,
+                      size_t maxStates = CORRAL_STATES);
+
+/// @brief The tests that need no search, for the position right after a push: isFreezeDeadlock() and a lookup in
+///        deadlockPatterns(). Cheap enough for every push generated; searches leave the corral test to the
+///        positions they expand.
+/// @param box Cell the pushed box ended on
+bool isLocalDeadlock(const Level &level, const Bitboard &boxes, int box);
+
+/// @brief Every test above for the position right after a push, plus a lookup in deadlockPatterns().
+/// @param box Cell the pushed box ended on
+/// @param reach Cells the player can walk to after the push
+bool isDeadlockAfterPush(const Level &level, const Bitboard &boxes, int box, const Bitboard &reach,
+                         size_t corralStates = CORRAL_STATES);
+
+#endif //SOKOBAN_DEADLOCK_H
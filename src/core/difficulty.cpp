@@ -0,0 +1,202 @@
+#include "difficulty.h"
+#include "deadlock.h"
+#include "patternDatabase.h"
+#include "search.h"
+#include "solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using std::cout, std::endl;
+
+namespace {
+    // bump when the scoring or the search changes, so old cache files are recomputed
+    const int CACHE_VERSION = 2;
+
+    // states an estimate may store, so a few hard levels in a big pack cannot use up memory
+    const size_t ESTIMATE_STATES = 4000000;
+}
+
+DifficultyTier difficultyTier(const Difficulty &difficulty) {
+    if (difficulty.score < 30)
+        return DifficultyTier::Easy;
+    return difficulty.score < 60 ? DifficultyTier::Medium : DifficultyTier::Hard;
+}
+
+const char *tierName(DifficultyTier tier) {
+    switch (tier) {
+        case DifficultyTier::Easy:   return "easy";
+        case DifficultyTier::Medium: return "medium";
+        default:                     return "hard";
+    }
+}
+
+uint64_t levelHash(const Level &level) {
+    // FNV-1a over the words of the level
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t word) {
+        for (int i {0}; i < 8; ++i) {
+            hash ^= (word >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    mix((uint64_t)level.width << 32 | (uint32_t)level.height);
+    mix((uint64_t)level.playerStart);
+    for (const Bitboard *board : {&level.walls, &level.targets, &level.boxes}) {
+        for (uint64_t word : board->words)
+            mix(word);
+    }
+    return hash;
+}
+
+uint64_t difficultyKey(const Level &level) {
+    const PatternDatabase &patterns = deadlockPatterns();
+    const uint64_t database = (uint64_t)patterns.size() << 8 | (uint64_t)patterns.windowSize();
+    // spread by a multiply, so databases of close sizes give far apart keys
+    return levelHash(level) ^ (database * 0x9e3779b97f4a7c15ULL);
+}
+
+Difficulty estimateDifficulty(const Level &level, double seconds, const std::atomic<bool> *cancel) {
+    SolverOptions options;
+    options.algorithm = SolverAlgorithm::AStar;
+    options.timeLimit = seconds;
+    options.stateLimit = ESTIMATE_STATES;
+    options.macros = true;
+    options.cancel = cancel;
+    const SolverResult result = solve(level, options);
+
+    Difficulty difficulty;
+    difficulty.solved = result.solved;
+    difficulty.expanded = result.expanded;
+    difficulty.score = 8.0f * (float)std::log10(1.0 + (double)result.expanded);
+    if (!result.solved) {
+        difficulty.score += 30;
+        return difficulty;
+    }
+
+    // every push on offer along the solution, and how many of them lose the level at once
+    Bitboard boxes = level.boxes;
+    int player = level.playerStart;
+    int offered = 0, traps = 0;
+    for (const Push &push : result.pushes) {
+        forEachPush(level, boxes, reachable(level, boxes, player), [&](const Push &option) {
+            const int to = option.box + level.offset(option.dir);
+            Bitboard after = boxes;
+            after.move(option.box, to);
+            ++offered;
+            if (level.isDead(to) || isDeadlockAfterPush(level, after, to, reachable(level, after, option.box)))
+                ++traps;
+        });
+        boxes.move(push.box, push.box + level.offset(push.dir));
+        player = push.box;
+    }
+    difficulty.pushes = (uint32_t)result.pushes.size();
+    if (!result.pushes.empty()) {
+        difficulty.branching = (float)(offered - traps) / (float)result.pushes.size();
+        difficulty.traps = offered > 0 ? (float)traps / (float)offered : 0.0f;
+    }
+    difficulty.score += 0.5f * (float)difficulty.pushes + difficulty.branching + 30.0f * difficulty.traps;
+    return difficulty;
+}
+
+bool DifficultyCache::load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in)
+        return true;
+    std::string magic;
+    int version = 0;
+    if (!(in >> magic >> version) || magic != "sokoban-difficulty") {
+        cout << path << " is not a difficulty cache" << endl;
+        return false;
+    }
+    if (version != CACHE_VERSION)
+        return true;
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t hash;
+    Difficulty difficulty;
+    int solved;
+    while (in >> std::hex >> hash >> std::dec >> difficulty.score >> solved >> difficulty.pushes
+              >> difficulty.expanded >> difficulty.branching >> difficulty.traps) {
+        difficulty.solved = solved != 0;
+        entries.emplace(hash, difficulty);
+    }
+    return true;
+}
+
+bool DifficultyCache::save(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out) {
+        cout << "could not write " << path << endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    // sorted, so the file only changes where the levels do
+    std::vector<std::pair<uint64_t, Difficulty>> sorted(entries.begin(), entries.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    out << "sokoban-difficulty " << CACHE_VERSION << "\n";
+    for (const auto &entry : sorted) {
+        const Difficulty &d = entry.second;
+        out << std::hex << entry.first << std::dec << " " << d.score << " " << d.solved << " " << d.pushes << " "
+            << d.expanded << " " << d.branching << " " << d.traps << "\n";
+    }
+    return (bool)out;
+}
+
+bool DifficultyCache::find(uint64_t hash, Difficulty &difficulty) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(hash);
+    if (found == entries.end())
+        return false;
+    difficulty = found->second;
+    return true;
+}
+
+void DifficultyCache::store(uint64_t hash, const Difficulty &difficulty) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[hash] = difficulty;
+    dirty = true;
+}
+
+bool DifficultyCache::changed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dirty;
+}
+
+std::vector<Difficulty> estimateDifficulties(const std::vector<Level> &levels, DifficultyCache &cache,
+                                             double secondsPerLevel, int threads, const std::atomic<bool> *cancel) {
+    std::vector<Difficulty> difficulties(levels.size());
+    std::vector<size_t> missing;
+    for (size_t i {0}; i < levels.size(); ++i) {
+        if (!cache.find(difficultyKey(levels[i]), difficulties[i]))
+            missing.push_back(i);
+    }
+    if (missing.empty())
+        return difficulties;
+
+    if (threads <= 0)
+        threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, (int)missing.size());
+    std::atomic<size_t> next {0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < missing.size(); i = next++) {
+            const Level &level = levels[missing[i]];
+            const Difficulty difficulty = estimateDifficulty(level, secondsPerLevel, cancel);
+            if (cancel && cancel->load())
+                break; // cut short, not a real estimate
+            difficulties[missing[i]] = difficulty;
+            if (difficulty.solved)
+                cache.store(difficultyKey(level), difficulty);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t {0}; t < threads; ++t)
+        pool.emplace_back(worker);
+    for (std::thread &thread : pool)
+        thread.join();
+    return difficulties;
+}
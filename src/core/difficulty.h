@@ -0,0 +1,95 @@
+#ifndef SOKOBAN_DIFFICULTY_H
+#define SOKOBAN_DIFFICULTY_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "level.h"
+
+/// @brief How hard a level is, estimated from solving it (see estimateDifficulty()).
+struct Difficulty {
+    /// @brief Higher is harder: about 10 for a warm-up, 60 and more for levels that take real search.
+    float score {0};
+
+    /// @brief Whether the estimate found a solution within its time budget (pushes, traps and branching are only
+    ///        known along a solution).
+    bool solved {false};
+    uint32_t pushes {0};
+    uint64_t expanded {0};
+
+    /// @brief Average pushes on offer per position along the solution that do not lose the level.
+    float branching {0};
+
+    /// @brief Share of the pushes on offer along the solution that lead straight into a deadlock.
+    float traps {0};
+};
+
+/// @brief Difficulty tiers for filtering, by score.
+enum class DifficultyTier : uint8_t {
+    Easy,   // score below 30
+    Medium, // below 60
+    Hard
+};
+
+DifficultyTier difficultyTier(const Difficulty &difficulty);
+
+/// @brief Name of a tier for display.
+const char *tierName(DifficultyTier tier);
+
+/// @brief Hash of everything that makes up a level (size, walls, targets, boxes, player), not its number, so a
+///        level keeps its cache entry when it is renumbered or moved to another pack.
+uint64_t levelHash(const Level &level);
+
+/// @brief The key of a level's entry in a DifficultyCache: levelHash() plus what else changes the estimate, the
+///        deadlock pattern database in use (patterns prune the search and so change the nodes counted).
+uint64_t difficultyKey(const Level &level);
+
+/// @brief Solves the level with A* (macro moves on) for up to seconds and scores it.
+/// @details score = 8 * log10(1 + nodes expanded) + 0.5 * pushes + branching + 30 * traps, plus 30 if no
+///          solution was found in time. Nodes stand for how much a player has to consider, pushes for how long the
+///          level is, branching and traps for how many wrong choices each step offers.
+/// @param cancel Optional flag another thread sets to stop the search early
+Difficulty estimateDifficulty(const Level &level, double seconds, const std::atomic<bool> *cancel = nullptr);
+
+/**
+ * @brief The DifficultyCache class.
+ * @details Difficulties by difficultyKey(), kept in a text file between runs so a pack is only ever estimated
+ *          once: a "sokoban-difficulty <version>" line, then one "key score solved pushes expanded branching
+ *          traps" line per level. A file of another version (another scoring) is ignored. Safe to use from several
+ *          threads.
+ */
+class DifficultyCache {
+public:
+    /// @brief Reads a cache file, keeping what is already in memory. A missing file is an empty cache.
+    /// @return false if the file exists but could not be read
+    bool load(const std::string &path);
+
+    /// @return false if the file could not be written
+    bool save(const std::string &path) const;
+
+    bool find(uint64_t hash, Difficulty &difficulty) const;
+    void store(uint64_t hash, const Difficulty &difficulty);
+
+    /// @brief True once store() added something that is not in the file yet.
+    bool changed() const;
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, Difficulty> entries;
+    bool dirty {false};
+};
+
+/// @brief Difficulties of many levels, from the cache where it has them, else estimated on threads (0 for one
+///        per hardware thread) and added to the cache.
+/// @details Only solved levels are added: whether a level is solved within secondsPerLevel depends on the machine,
+///          so an unsolved estimate is made again next time rather than kept. Once cancel is set the levels not
+///          yet estimated are left at a zero score and nothing more is cached.
+std::vector<Difficulty> estimateDifficulties(const std::vector<Level> &levels, DifficultyCache &cache,
+                                             double secondsPerLevel, int threads = 0,
+                                             const std::atomic<bool> *cancel = nullptr);
+
+#endif //SOKOBAN_DIFFICULTY_H
@@ -0,0 +1,106 @@
+#include "game.h"
+#include "deadlock.h"
+#include "patternDatabase.h"
+#include "search.h"
+#include "zobrist.h"
+
+Game::Game(const Level &level) {
+    load(level);
+}
+
+void Game::load(const Level &newLevel) {
+    level = newLevel;
+    reset();
+}
+
+void Game::reset() {
+    boxes = level.boxes;
+    player = level.playerStart;
+    hash = zobristHash(boxes, player);
+    moves = 0;
+    pushes = 0;
+    deadlockMove = -1;
+    journal.clear();
+}
+
+bool Game::placePlayer(int cell) {
+    if (cell < 0 || cell >= level.cellCount() || level.isWall(cell) || boxes.test(cell))
+        return false;
+    player = cell;
+    hash = zobristHash(boxes, player);
+    moves = 0;
+    pushes = 0;
+    deadlockMove = -1;
+    journal.clear();
+    return true;
+}
+
+StepResult Game::step(Direction dir) {
+    // a new move drops the redo history, and with it a deadlock that was undone
+    if (deadlockMove > moves)
+        deadlockMove = -1;
+    StepResult result = apply(dir);
+    if (result != StepResult::Blocked)
+        journal.record(dir, result == StepResult::Pushed);
+    return result;
+}
+
+StepResult Game::undo() {
+    if (!journal.canUndo())
+        return StepResult::Blocked;
+    const JournalEntry entry = journal.undo();
+    const int delta = level.offset(entry.dir);
+    // the box (if any) is in front of the player and goes back to where the player stands
+    if (entry.pushed) {
+        moveBox(player + delta, player);
+        --pushes;
+    }
+    movePlayer(player - delta);
+    --moves;
+    return entry.pushed ? StepResult::Pushed : StepResult::Moved;
+}
+
+StepResult Game::redo() {
+    if (!journal.canRedo())
+        return StepResult::Blocked;
+    return apply(journal.redo().dir);
+}
+
+StepResult Game::apply(Direction dir) {
+    // The level is surrounded by walls, so next and beyond are always valid indices:
+    // next is only a padding cell if it is a wall, and then we never look past it.
+    const int delta = level.offset(dir);
+    const int next = player + delta;
+    if (level.isWall(next))
+        return StepResult::Blocked;
+
+    if (boxes.test(next)) {
+        const int beyond = next + delta;
+        if (level.isWall(beyond) || boxes.test(beyond))
+            return StepResult::Blocked;
+        moveBox(next, beyond);
+        movePlayer(next);
+        ++moves;
+        ++pushes;
+        if (!isDeadlocked() &&
+            (level.isDead(beyond) || isFreezeDeadlock(level, boxes, beyond) ||
+             (patterns && patterns->isDeadlock(level, boxes, beyond)) ||
+             (corralCheck && isCorralDeadlock(level, boxes, beyond, reachable(level, boxes, player)))))
+            deadlockMove = moves;
+        return StepResult::Pushed;
+    }
+
+    movePlayer(next);
+    ++moves;
+    return StepResult::Moved;
+}
+
+void Game::movePlayer(int to) {
+    hash ^= ZOBRIST.player[player] ^ ZOBRIST.player[to];
+    player = to;
+}
+
+void Game::moveBox(int from, int to) {
+    hash ^= ZOBRIST.box[from] ^ ZOBRIST.box[to];
+    boxes.move(from, to);
+}
@@ -0,0 +1,127 @@
+#ifndef SOKOBAN_GAME_H
+#define SOKOBAN_GAME_H
+
+#include <cstdint>
+
+#include "level.h"
+#include "moveJournal.h"
+
+class PatternDatabase;
+
+/// @brief What a call to Game::step() did.
+enum class StepResult : uint8_t {
+    Blocked,    // nothing changed
+    Moved,      // the player walked onto an empty tile
+    Pushed      // the player pushed a box
+};
+
+/**
+ * @brief The Game class.
+ * @details Holds the rules and the dynamic state (player and boxes) of a level. It has no OpenGL or GLFW
+ *          dependencies so it can be simulated without a window; the Engine renders from it.
+ * @see Level
+ */
+class Game {
+public:
+    Game() = default;
+
+    /// @brief Construct a game and load a level.
+    explicit Game(const Level &level);
+
+    /// @brief Replaces the current level and resets to its starting position.
+    void load(const Level &level);
+
+    /// @brief Puts the player and the boxes back to where the level starts and clears the journal.
+    void reset();
+
+    /// @brief Moves the player to a cell without making a move, as if the level started there.
+    /// @details For a level reloaded while it is played: the boxes keep their places and the journal is cleared.
+    /// @return false (and nothing changes) if the cell is a wall or holds a box
+    bool placePlayer(int cell);
+
+    /// @brief Attempts to move the player in a given direction
+    /// @details If there is a box in the way, it is pushed when the tile behind it is neither a wall nor a box.
+    ///          Successful moves are recorded in the journal.
+    /// @return Blocked if nothing changed, Moved or Pushed otherwise
+    StepResult step(Direction dir);
+
+    /// @brief Reverts the last move in constant time.
+    /// @return Blocked if there is nothing to undo, otherwise whether the reverted move was a push
+    StepResult undo();
+
+    /// @brief Replays the last undone move.
+    /// @return Blocked if there is nothing to redo, Moved or Pushed otherwise
+    StepResult redo();
+
+    /// @brief True when every box is on a target.
+    /// @details A mask test over a few words, no scan of the board.
+    bool isSolved() const { return boxes.andNot(level.targets).none(); }
+
+    /// @brief True once a push has made the level unwinnable, until it is undone.
+    /// @details Every push is checked for dead squares and frozen boxes, for deadlock patterns if
+    ///          setDeadlockPatterns() gave a database and for corrals around the pushed box if setCorralCheck()
+    ///          turned that on.
+    /// @see isFreezeDeadlock(), isCorralDeadlock()
+    bool isDeadlocked() const { return deadlockMove >= 0 && moves >= deadlockMove; }
+
+    /// @brief Whether pushes are also checked for corral deadlocks (off by default).
+    /// @details The corral test is a small search of its own, worth it only when a player is told about the
+    ///          deadlock; replays and other headless games leave it off.
+    void setCorralCheck(bool check) { corralCheck = check; }
+
+    /// @brief The deadlock patterns pushes are looked up in, nullptr for none (the default).
+    /// @details Like the corral test, only wanted when a player is told about the deadlock. The database is not
+    ///          copied and has to outlive the game.
+    void setDeadlockPatterns(const PatternDatabase *database) { patterns = database; }
+
+    // -----------------------------------
+    // Getters
+    // -----------------------------------
+    const Level &getLevel() const { return level; }
+    int getPlayer() const { return player; }
+    bool hasBox(int cell) const { return boxes.test(cell); }
+    const Bitboard &getBoxes() const { return boxes; }
+    int getMoves() const { return moves; }
+    int getPushes() const { return pushes; }
+    const MoveJournal &getJournal() const { return journal; }
+
+    /// @brief 64-bit Zobrist hash of the position (player cell and box set).
+    /// @details Updated incrementally by every move, undo and redo.
+    /// @see zobristHash()
+    uint64_t getHash() const { return hash; }
+
+private:
+    /// @brief The move rules, shared by step() and redo().
+    StepResult apply(Direction dir);
+
+    /// @brief Move the player / a box and update the hash.
+    void movePlayer(int to);
+    void moveBox(int from, int to);
+
+    /// @brief The static layer of the current level.
+    Level level;
+
+    /// @brief Cells currently holding a box.
+    Bitboard boxes;
+
+    /// @brief Cell the player is standing on.
+    int player {0};
+
+    /// @brief Zobrist hash of player and boxes.
+    uint64_t hash {0};
+
+    int moves {0};
+    int pushes {0};
+
+    bool corralCheck {false};
+    const PatternDatabase *patterns {nullptr};
+
+    /// @brief Move count right after the push that lost the level, -1 if it has not been lost.
+    /// @details Positions before it were checked when they were reached, so undo only has to compare counts.
+    int deadlockMove {-1};
+
+    /// @brief Moves made since the last reset(), used by undo() and redo().
+    MoveJournal journal;
+};
+
+#endif //SOKOBAN_GAME_H
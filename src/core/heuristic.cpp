@@ -0,0 +1,123 @@
+#include "heuristic.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // cost of a box/target pair that cannot be matched, large enough that any matching using one is detected
+    const int NO_MATCH = 1 << 20;
+}
+
+int minCostMatching(const std::vector<int> &cost, int rows, int cols) {
+    MatchingScratch scratch;
+    return minCostMatching(cost, rows, cols, scratch);
+}
+
+int minCostMatching(const std::vector<int> &cost, int rows, int cols, MatchingScratch &scratch) {
+    // Hungarian algorithm with potentials, 1-indexed, column 0 is a sentinel
+    const int INF = std::numeric_limits<int>::max() / 2;
+    // assign() keeps the capacity, so after the first call nothing is allocated
+    std::vector<int> &u = scratch.u, &v = scratch.v, &match = scratch.match, &way = scratch.way;
+    std::vector<int> &minv = scratch.minv;
+    std::vector<char> &used = scratch.used;
+    u.assign(rows + 1, 0);
+    v.assign(cols + 1, 0);
+    match.assign(cols + 1, 0);
+    way.assign(cols + 1, 0);
+    minv.resize(cols + 1);
+    used.resize(cols + 1);
+
+    for (int row {1}; row <= rows; ++row) {
+        match[0] = row;
+        int col0 = 0;
+        std::fill(minv.begin(), minv.end(), INF);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[col0] = 1;
+            const int row0 = match[col0];
+            int delta = INF, col1 = 0;
+            for (int col {1}; col <= cols; ++col) {
+                if (used[col])
+                    continue;
+                const int current = cost[(row0 - 1) * cols + (col - 1)] - u[row0] - v[col];
+                if (current < minv[col]) {
+                    minv[col] = current;
+                    way[col] = col0;
+                }
+                if (minv[col] < delta) {
+                    delta = minv[col];
+                    col1 = col;
+                }
+            }
+            for (int col {0}; col <= cols; ++col) {
+                if (used[col]) {
+                    u[match[col]] += delta;
+                    v[col] -= delta;
+                } else {
+                    minv[col] -= delta;
+                }
+            }
+            col0 = col1;
+        } while (match[col0] != 0);
+        // flip the augmenting path
+        do {
+            const int col1 = way[col0];
+            match[col0] = match[col1];
+            col0 = col1;
+        } while (col0 != 0);
+    }
+
+    int total = 0;
+    for (int col {1}; col <= cols; ++col) {
+        if (match[col] != 0)
+            total += cost[(match[col] - 1) * cols + (col - 1)];
+    }
+    return total;
+}
+
+PushDistances::PushDistances(const Level &level) {
+    level.targets.forEach([this](int target) { targets.push_back(target); });
+    distance.assign(targets.size() * MAX_CELLS, UNREACHABLE);
+
+    int queue[MAX_CELLS];
+    for (int t {0}; t < (int)targets.size(); ++t) {
+        uint16_t *dist = &distance[t * MAX_CELLS];
+        int head = 0, tail = 0;
+        dist[targets[t]] = 0;
+        queue[tail++] = targets[t];
+        // breadth-first over pulls: a box on cell can be pulled to cell + delta if the player has room behind it
+        while (head < tail) {
+            const int cell = queue[head++];
+            for (int d {0}; d < 4; ++d) {
+                const int delta = level.offset(static_cast<Direction>(d));
+                const int to = cell + delta;
+                if (!level.isWall(to) && !level.isWall(to + delta) && dist[to] == UNREACHABLE) {
+                    dist[to] = (uint16_t)(dist[cell] + 1);
+                    queue[tail++] = to;
+                }
+            }
+        }
+    }
+}
+
+int PushDistances::lowerBound(const Bitboard &boxes) const {
+    const int cols = targetCount();
+    cost.clear();
+    int rows = 0;
+    bool stuck = false;
+    boxes.forEach([&](int box) {
+        bool reachesAny = false;
+        for (int t {0}; t < cols; ++t) {
+            const int d = get(t, box);
+            reachesAny = reachesAny || d != UNREACHABLE;
+            cost.push_back(d == UNREACHABLE ? NO_MATCH : d);
+        }
+        stuck = stuck || !reachesAny;
+        ++rows;
+    });
+    if (stuck || rows > cols)
+        return UNREACHABLE;
+
+    const int total = minCostMatching(cost, rows, cols, scratch);
+    return total >= NO_MATCH ? UNREACHABLE : total;
+}
@@ -0,0 +1,58 @@
+#ifndef SOKOBAN_HEURISTIC_H
+#define SOKOBAN_HEURISTIC_H
+
+#include <cstdint>
+#include <vector>
+
+#include "level.h"
+
+/// @brief Working memory of minCostMatching(), kept by callers that match often so it is allocated only once.
+struct MatchingScratch {
+    std::vector<int> u, v, match, way, minv;
+    std::vector<char> used;
+};
+
+/// @brief Minimum cost perfect matching of rows to columns (Hungarian algorithm, O(rows^2 * cols)).
+/// @param cost rows x cols matrix in row-major order, rows <= cols
+/// @return the total cost of the cheapest assignment giving every row its own column
+int minCostMatching(const std::vector<int> &cost, int rows, int cols, MatchingScratch &scratch);
+int minCostMatching(const std::vector<int> &cost, int rows, int cols);
+
+/**
+ * @brief The PushDistances class.
+ * @details Precomputes, for every target, the fewest pushes needed to bring a box from any cell onto it while
+ *          ignoring the other boxes. Computed once per level by pulling a box backwards from each target.
+ *
+ *          lowerBound() matches boxes to distinct targets at minimum total distance. Every push moves one box one
+ *          tile, so this never overestimates the pushes left (admissible) and changes by at most 1 per push
+ *          (consistent), which keeps A* push-optimal.
+ *
+ *          lowerBound() runs on every node, so it reuses buffers held by the object: one search (and one thread)
+ *          per instance.
+ */
+class PushDistances {
+public:
+    /// @brief Returned for boxes that cannot reach any target.
+    static constexpr int UNREACHABLE = 0xffff;
+
+    explicit PushDistances(const Level &level);
+
+    /// @brief Pushes to bring a box from cell onto the i-th target, UNREACHABLE if impossible.
+    int get(int target, int cell) const { return distance[target * MAX_CELLS + cell]; }
+
+    int targetCount() const { return (int)targets.size(); }
+
+    /// @brief Admissible estimate of the pushes left to solve the position.
+    /// @return UNREACHABLE if the boxes cannot all be matched to targets (a deadlock)
+    int lowerBound(const Bitboard &boxes) const;
+
+private:
+    std::vector<int> targets;
+    std::vector<uint16_t> distance;
+
+    // lowerBound()'s cost matrix and matching buffers
+    mutable std::vector<int> cost;
+    mutable MatchingScratch scratch;
+};
+
+#endif //SOKOBAN_HEURISTIC_H
@@ -0,0 +1,112 @@
+#include "hint.h"
+#include "solver.h"
+#include "zobrist.h"
+
+namespace {
+    uint64_t positionKey(const Level &level, const Bitboard &boxes, int player) {
+        return zobristBoxes(boxes) ^ ZOBRIST.player[normalizedPlayer(level, boxes, player)];
+    }
+}
+
+HintSolver::HintSolver() {
+    // started here rather than in the initializer list, so every member it reads is initialized
+    worker = std::thread(&HintSolver::run, this);
+}
+
+HintSolver::~HintSolver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        cancelled = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void HintSolver::setTimeBudget(double seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    timeBudget = seconds;
+}
+
+void HintSolver::setMemoryBudget(size_t megabytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryBudgetMb = megabytes;
+}
+
+void HintSolver::request(const Level &level, const Bitboard &boxes, int player) {
+    const uint64_t key = positionKey(level, boxes, player);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++generation;
+        cancelled = true;
+        if (level.walls != cacheWalls || level.targets != cacheTargets) {
+            cache.clear();
+            cacheWalls = level.walls;
+            cacheTargets = level.targets;
+        }
+        auto cached = cache.find(key);
+        if (cached != cache.end()) {
+            hasJob = false;
+            result = {HintStatus::Found, cached->second, false};
+            return;
+        }
+        job = level;
+        job.boxes = boxes;
+        job.playerStart = player;
+        hasJob = true;
+        result = {HintStatus::Searching, {0, Direction::Up}, false};
+    }
+    wake.notify_one();
+}
+
+void HintSolver::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    hasJob = false;
+    cancelled = true;
+    result = Hint();
+}
+
+Hint HintSolver::current() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return result;
+}
+
+void HintSolver::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return hasJob || quit; });
+        if (quit)
+            return;
+        const Level level = job;
+        const uint64_t jobGeneration = generation;
+        SolverOptions options;
+        options.algorithm = SolverAlgorithm::AStar;
+        options.timeLimit = timeBudget;
+        options.memoryLimitMb = memoryBudgetMb;
+        options.cancel = &cancelled;
+        hasJob = false;
+        cancelled = false;
+        lock.unlock();
+
+        const SolverResult solution = solve(level, options);
+
+        lock.lock();
+        if (solution.solved && level.walls == cacheWalls && level.targets == cacheTargets) {
+            // every position on the way gets its next push, the solution from there is the rest of this one
+            Bitboard boxes = level.boxes;
+            int player = level.playerStart;
+            for (const Push &push : solution.pushes) {
+                cache[positionKey(level, boxes, player)] = push;
+                boxes.move(push.box, push.box + level.offset(push.dir));
+                player = push.box;
+            }
+        }
+        if (jobGeneration == generation) {
+            if (solution.solved && !solution.pushes.empty())
+                result = {HintStatus::Found, solution.pushes.front(), false};
+            else
+                result = {HintStatus::NotFound, {0, Direction::Up}, solution.unsolvable};
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef SOKOBAN_HINT_H
+#define SOKOBAN_HINT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "level.h"
+#include "search.h"
+
+enum class HintStatus : uint8_t {
+    None,       // nothing asked, or the request was cancelled
+    Searching,  // the worker is still looking
+    Found,      // push holds the next push of a solution
+    NotFound    // no solution within the time or memory budget, or none at all (unsolvable)
+};
+
+struct Hint {
+    HintStatus status {HintStatus::None};
+    Push push {0, Direction::Up};
+    bool unsolvable {false};
+};
+
+/**
+ * @brief The HintSolver class.
+ * @details Finds the next push towards a solution on a worker thread, so the caller (the render loop) only ever
+ *          takes a short lock: request() hands over a position and returns, current() reads the latest answer.
+ *          A new request or cancel() stops the search that is running.
+ *
+ *          Every position along a solution that was found is cached with its next push, keyed by the Zobrist hash
+ *          of the boxes and the normalized player, so asking again anywhere on that path answers at once. The
+ *          cache is dropped when the level changes.
+ */
+class HintSolver {
+public:
+    HintSolver();
+    ~HintSolver();
+
+    HintSolver(const HintSolver &) = delete;
+    HintSolver &operator=(const HintSolver &) = delete;
+
+    /// @brief Seconds the worker may search before giving up (default 2).
+    void setTimeBudget(double seconds);
+
+    /// @brief Megabytes of search states the worker may hold before giving up (default 64), so a hint on a hard
+    ///        level cannot grow the game without bound.
+    void setMemoryBudget(size_t megabytes);
+
+    /// @brief Asks for the next push from a position, answered from the cache if it is there.
+    void request(const Level &level, const Bitboard &boxes, int player);
+
+    /// @brief Forgets the current request and stops its search, e.g. because the player moved.
+    void cancel();
+
+    /// @brief The answer to the latest request, Searching until the worker is done.
+    Hint current() const;
+
+private:
+    void run();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+
+    /// @brief Stops the search in progress, see SolverOptions::cancel.
+    std::atomic<bool> cancelled {false};
+    bool quit {false};
+
+    // the position waiting for the worker, as a level starting from it
+    bool hasJob {false};
+    Level job;
+    double timeBudget {2.0};
+    size_t memoryBudgetMb {64};
+
+    /// @brief Bumped by every request and cancel, answers from older requests are dropped.
+    uint64_t generation {0};
+    Hint result;
+
+    // next push by position, for the level with these walls and targets
+    std::unordered_map<uint64_t, Push> cache;
+    Bitboard cacheWalls, cacheTargets;
+};
+
+#endif //SOKOBAN_HINT_H
@@ -0,0 +1,164 @@
+#include "solver.h"
+#include "deadlock.h"
+#include "heuristic.h"
+#include "macros.h"
+#include "nodeStore.h"
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+// Iterative deepening A*: depth-first passes that cut off every node whose f = g + h exceeds a bound, the bound
+// raised to the smallest f that was cut off until a pass finds a solution. With the consistent push distance
+// heuristic the first solution found is push-optimal, as with A*. Only the current path and the children of each
+// node on it are kept, so memory grows with the solution length instead of with the states visited; the price is
+// that the last passes search much of the earlier ones again.
+//
+// Positions already on the path are skipped, which cuts push cycles. An optional transposition table skips
+// positions met before in the same pass at the same or a smaller depth, which cuts transpositions as well.
+
+namespace {
+    const int FOUND = -1;
+    const int NOT_FOUND = INT_MAX;
+
+    struct Child {
+        SearchNode node;
+        Push push;
+        int h;
+    };
+
+    class IdaSearch {
+    public:
+        IdaSearch(const Level &level, const PushDistances &distances, const MacroMoves &macros,
+                  TranspositionTable *table, SearchBudget &budget, SolverResult &result)
+            : level(level), distances(distances), macros(macros), table(table), budget(budget), result(result) {}
+
+        /// @brief One pass below the node at the end of path, whose heuristic is h.
+        /// @return FOUND with the solution in pushes, else the smallest f above bound that was cut off
+        ///         (NOT_FOUND if none was, or the search ran out of budget, see stopped)
+        int search(int h, int bound) {
+            const SearchNode node = path.back();
+            const int f = node.depth + h;
+            if (f > bound)
+                return f;
+            if (node.boxes.andNot(level.targets).none())
+                return FOUND;
+            if (budget.exceeded(result.generated)) {
+                stopped = true;
+                return NOT_FOUND;
+            }
+            ++result.expanded;
+            ++passNodes;
+
+            std::vector<Child> children;
+            const Bitboard reach = reachable(level, node.boxes, node.player);
+            forEachPush(level, node.boxes, reach, [&](const Push &push) {
+                if (level.isDead(push.box + level.offset(push.dir)))
+                    return;
+                const SearchNode child = macros.child(node, 0, push);
+                for (const SearchNode &onPath : path) {
+                    if (onPath.hash == child.hash && onPath.boxes == child.boxes)
+                        return;
+                }
+                const int childH = distances.lowerBound(child.boxes);
+                if (childH == PushDistances::UNREACHABLE)
+                    return;
+                ++result.generated;
+                if (isDeadlockAfterPush(level, child.boxes, child.boxes.andNot(node.boxes).first(),
+                                        reachable(level, child.boxes, child.player)))
+                    return;
+                children.push_back({child, push, childH});
+            });
+            // most promising first, so the last pass ends as early as it can
+            std::stable_sort(children.begin(), children.end(), [](const Child &a, const Child &b) {
+                return a.node.depth + a.h < b.node.depth + b.h;
+            });
+
+            int next = NOT_FOUND;
+            for (const Child &child : children) {
+                if (table && !table->insert(child.node.hash, child.node.depth))
+                    continue;
+                path.push_back(child.node);
+                pushes.push_back(child.push);
+                const int t = search(child.h, bound);
+                if (t == FOUND)
+                    return FOUND;
+                path.pop_back();
+                pushes.pop_back();
+                if (stopped)
+                    return NOT_FOUND;
+                next = std::min(next, t);
+            }
+            return next;
+        }
+
+        std::vector<SearchNode> path;   // root first
+        std::vector<Push> pushes;       // path[i + 1] was reached by pushes[i]
+        uint64_t passNodes {0};
+        bool stopped {false};
+
+    private:
+        const Level &level;
+        const PushDistances &distances;
+        const MacroMoves &macros;
+        TranspositionTable *table;
+        SearchBudget &budget;
+        SolverResult &result;
+    };
+}
+
+SolverResult solveIdaStar(const Level &level, const SolverOptions &options) {
+    SolverResult result;
+    // Nothing is stored but the path and the table, whose size is fixed up front: the memory cap bounds the
+    // table instead of becoming a state limit, and the state limit counts the nodes generated.
+    SolverOptions limits = options;
+    limits.memoryLimitMb = 0;
+    SearchBudget budget(limits);
+    size_t tableMegabytes = options.tableMegabytes;
+    if (options.memoryLimitMb > 0)
+        tableMegabytes = std::min(tableMegabytes, options.memoryLimitMb);
+
+    const PushDistances distances(level);
+    const MacroMoves macros(level, options.macros);
+    std::unique_ptr<TranspositionTable> table;
+    if (tableMegabytes > 0)
+        table.reset(new TranspositionTable(tableMegabytes, options.replacement));
+
+    const SearchNode root = rootNode(level);
+    const int rootH = distances.lowerBound(root.boxes);
+    result.generated = 1;
+    if (rootH == PushDistances::UNREACHABLE) {
+        result.unsolvable = true;
+        return result;
+    }
+
+    IdaSearch search(level, distances, macros, table.get(), budget, result);
+    for (int bound = rootH;;) {
+        if (table) {
+            table->clear();
+            table->insert(root.hash, 0);
+        }
+        search.path.assign(1, root);
+        search.pushes.clear();
+        search.passNodes = 0;
+        const int next = search.search(rootH, bound);
+        result.iterationNodes.push_back(search.passNodes);
+        if (table) {
+            result.tableEntries = table->size();
+            result.tableFailedInserts = table->failedInserts();
+        }
+        if (next == FOUND) {
+            result.solved = true;
+            result.pushes = macros.expand(search.pushes);
+            return result;
+        }
+        if (search.stopped)
+            return result;
+        // nothing was cut off: every position was searched
+        if (next == NOT_FOUND) {
+            result.unsolvable = true;
+            return result;
+        }
+        bound = next;
+    }
+}
@@ -0,0 +1,267 @@
+#include "level.h"
+#include "levelPack.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+
+using std::string, std::vector, std::cout, std::endl;
+
+namespace {
+    // A level header is a line starting with the level number, e.g. "1 # Level 1 : ..."
+    bool isHeader(const string &line) {
+        return !line.empty() && isdigit(static_cast<unsigned char>(line[0]));
+    }
+
+    // Map rows end at the next header, a comment or an empty line
+    bool isMapRow(const string &line) {
+        return !line.empty() && !isHeader(line) && line[0] != '#';
+    }
+}
+
+bool parseLevel(std::istream &in, int id, Level &level) {
+    string line;
+    bool found = false;
+    // skip to the requested level
+    while (getline(in, line)) {
+        if (isHeader(line) && strtol(line.c_str(), nullptr, 10) == id) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        cout << "level " << id << " not found" << endl;
+        return false;
+    }
+
+    vector<string> rows;
+    while (getline(in, line)) {
+        // tolerate files saved with windows line endings
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!isMapRow(line))
+            break;
+        rows.push_back(line);
+    }
+
+    return buildLevel(rows, id, level);
+}
+
+bool buildLevel(const std::vector<std::string> &rows, int id, Level &level, bool closeOutside) {
+    level = Level();
+    level.id = id;
+    level.rows = (int)rows.size();
+    for (const string &row : rows)
+        level.cols = std::max(level.cols, (int)row.size());
+    level.width = level.cols + 2;
+    level.height = level.rows + 2;
+    if (level.cellCount() > MAX_CELLS) {
+        cout << "level " << id << " is too large: " << level.cols << "x" << level.rows << endl;
+        return false;
+    }
+    // everything starts as a wall, which also builds the padding ring and fills out short rows
+    for (int cell {0}; cell < level.cellCount(); ++cell)
+        level.walls.set(cell);
+    level.playerStart = -1;
+
+    for (int row {0}; row < level.rows; ++row) {
+        for (int col {0}; col < (int)rows[row].size(); ++col) {
+            const int cell = level.cell(row, col);
+            switch (rows[row][col]) {
+                case '_': level.walls.reset(cell); break;
+                case 'X': break;
+                case '*': {
+                    level.walls.reset(cell);
+                    level.boxes.set(cell);
+                    break;
+                }
+                case '!': {
+                    level.walls.reset(cell);
+                    level.targets.set(cell);
+                    break;
+                }
+                case '@': {
+                    level.walls.reset(cell);
+                    level.playerStart = cell;
+                    break;
+                }
+                case '$': {
+                    level.walls.reset(cell);
+                    level.targets.set(cell);
+                    level.boxes.set(cell);
+                    break;
+                }
+                case '+': {
+                    level.walls.reset(cell);
+                    level.targets.set(cell);
+                    level.playerStart = cell;
+                    break;
+                }
+                default: {
+                    cout << "invalid character in level " << id << " map: " << rows[row] << endl;
+                }
+            }
+        }
+    }
+
+    if (level.playerStart < 0) {
+        cout << "level " << id << " has no player" << endl;
+        return false;
+    }
+    if (closeOutside) {
+        // flood fill from the player through everything but walls, what it misses is outside the level
+        Bitboard inside;
+        int queue[MAX_CELLS];
+        int head = 0, tail = 0;
+        inside.set(level.playerStart);
+        queue[tail++] = level.playerStart;
+        while (head < tail) {
+            const int cell = queue[head++];
+            for (int d {0}; d < 4; ++d) {
+                const int next = cell + level.offset(static_cast<Direction>(d));
+                if (!level.isWall(next) && !inside.test(next)) {
+                    inside.set(next);
+                    queue[tail++] = next;
+                }
+            }
+        }
+        for (int cell {0}; cell < level.cellCount(); ++cell) {
+            if (!inside.test(cell) && !level.boxes.test(cell) && !level.targets.test(cell))
+                level.walls.set(cell);
+        }
+    }
+    level.dead = deadSquares(level);
+    level.tunnels[0] = tunnelCells(level, 0);
+    level.tunnels[1] = tunnelCells(level, 1);
+    level.goalRoom = findGoalRoom(level, level.goalEntrance);
+    return true;
+}
+
+Bitboard deadSquares(const Level &level) {
+    Bitboard alive;
+    int queue[MAX_CELLS];
+    int head = 0, tail = 0;
+    level.targets.forEach([&](int target) {
+        alive.set(target);
+        queue[tail++] = target;
+    });
+    while (head < tail) {
+        const int box = queue[head++];
+        for (int d {0}; d < 4; ++d) {
+            const int delta = level.offset(static_cast<Direction>(d));
+            // the player stands on box + delta and steps back to box + 2 * delta, pulling the box along
+            const int to = box + delta;
+            if (!level.isWall(to) && !level.isWall(to + delta) && !alive.test(to)) {
+                alive.set(to);
+                queue[tail++] = to;
+            }
+        }
+    }
+    Bitboard dead;
+    for (int cell {0}; cell < level.cellCount(); ++cell) {
+        if (!level.isWall(cell) && !alive.test(cell))
+            dead.set(cell);
+    }
+    return dead;
+}
+
+std::vector<int> listLevels(const std::string &path) {
+    vector<int> ids;
+    LevelPack pack;
+    pack.open(path);
+    for (int i {0}; i < pack.size(); ++i)
+        ids.push_back(pack.id(i));
+    return ids;
+}
+
+bool loadLevel(const std::string &path, int id, Level &level) {
+    LevelPack pack;
+    return pack.open(path) && pack.loadId(id, level);
+}
+
+Bitboard tunnelCells(const Level &level, int axis) {
+    const int side = axis == 0 ? 1 : level.width;
+    Bitboard tunnels;
+    for (int cell {level.width}; cell < level.cellCount() - level.width; ++cell) {
+        if (!level.isWall(cell) && level.isWall(cell - side) && level.isWall(cell + side))
+            tunnels.set(cell);
+    }
+    return tunnels;
+}
+
+Bitboard findGoalRoom(const Level &level, int &entrance) {
+    entrance = -1;
+    Bitboard best;
+    if (level.targets.none() || level.targets.count() != level.boxes.count())
+        return best;
+    int queue[MAX_CELLS];
+    for (int cell {level.width}; cell < level.cellCount() - level.width; ++cell) {
+        if (level.isWall(cell) || level.isTarget(cell))
+            continue;
+        for (int d {0}; d < 4; ++d) {
+            const int delta = level.offset(static_cast<Direction>(d));
+            if (level.isWall(cell + delta) || level.isWall(cell - delta))
+                continue;
+            // flood the side behind cell + delta with cell itself closed
+            Bitboard room;
+            int head = 0, tail = 0;
+            room.set(cell + delta);
+            queue[tail++] = cell + delta;
+            while (head < tail) {
+                const int from = queue[head++];
+                for (int e {0}; e < 4; ++e) {
+                    const int to = from + level.offset(static_cast<Direction>(e));
+                    if (to != cell && !level.isWall(to) && !room.test(to)) {
+                        room.set(to);
+                        queue[tail++] = to;
+                    }
+                }
+            }
+            bool oneSide = true;
+            for (int e {0}; e < 4; ++e) {
+                if (e != d && room.test(cell + level.offset(static_cast<Direction>(e))))
+                    oneSide = false;
+            }
+            if (oneSide && level.targets.andNot(room).none() && (room & level.boxes).none() &&
+                !room.test(level.playerStart) && (best.none() || room.count() < best.count())) {
+                best = room;
+                entrance = cell;
+            }
+        }
+    }
+    return best;
+}
+
+std::string boardToText(const Level &level, const Bitboard &boxes, int player) {
+    string text;
+    for (int row {0}; row < level.rows; ++row) {
+        for (int col {0}; col < level.cols; ++col) {
+            const int cell = level.cell(row, col);
+            if (cell == player)
+                text += level.isTarget(cell) ? '+' : '@';
+            else if (level.isWall(cell))
+                text += 'X';
+            else if (boxes.test(cell))
+                text += level.isTarget(cell) ? '$' : '*';
+            else
+                text += level.isTarget(cell) ? '!' : '_';
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+bool loadLevels(const std::string &path, std::vector<Level> &levels, std::vector<int> *invalid) {
+    LevelPack pack;
+    if (!pack.open(path))
+        return false;
+    for (int i {0}; i < pack.size(); ++i) {
+        Level level;
+        if (pack.load(i, level))
+            levels.push_back(level);
+        else if (invalid)
+            invalid->push_back(pack.id(i));
+    }
+    return true;
+}
@@ -0,0 +1,139 @@
+#ifndef SOKOBAN_LEVEL_H
+#define SOKOBAN_LEVEL_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+
+/// @brief Directions the player can move in.
+/// @details The order matters: opposite directions only differ in their lowest bit (see opposite()).
+enum class Direction : uint8_t {
+    Up,
+    Down,
+    Left,
+    Right
+};
+
+/// @brief Returns the direction that undoes a move in dir.
+inline Direction opposite(Direction dir) { return static_cast<Direction>(static_cast<uint8_t>(dir) ^ 1); }
+
+/**
+ * @brief A parsed level.
+ * @details Levels are laid out as a grid surrounded by a ring of walls, so every neighbour of a playable cell
+ *          is a valid index and the move logic never needs bounds checks. Cells are addressed by a single index:
+ *          cell(row, col) = (row + 1) * width + (col + 1).
+ *          The static layer is kept as bitboards, so the padded grid must fit in MAX_CELLS.
+ *
+ *          Rows keep the orientation of res/maps.txt, i.e. row 0 is the first line of the map and is rendered at
+ *          the bottom of the screen, so moving Up increases the row.
+ */
+struct Level {
+    /// @brief The number in front of the level in the maps file.
+    int id {0};
+
+    /// @brief Size of the playable area (what is written in the maps file).
+    int rows {0}, cols {0};
+
+    /// @brief Size of the padded grid, (rows + 2) x (cols + 2).
+    int width {0}, height {0};
+
+    /// @brief Walls, including the padding ring. Every other cell is floor.
+    Bitboard walls;
+
+    /// @brief Cells boxes have to be pushed onto.
+    Bitboard targets;
+
+    /// @brief Cells holding a box when the level starts.
+    Bitboard boxes;
+
+    /// @brief Cell the player starts on.
+    int playerStart {0};
+
+    /// @brief Floor cells a box can never be pushed from onto any target (see deadSquares()).
+    /// @details Filled in by parseLevel(). A box pushed onto one of them loses the level.
+    Bitboard dead;
+
+    /// @brief Floor cells in a one-wide tunnel (see tunnelCells()): tunnels[0] has walls left and right, so a box
+    ///        there only moves Up or Down, tunnels[1] has walls above and below. Filled in by parseLevel().
+    Bitboard tunnels[2];
+
+    /// @brief The goal room (see findGoalRoom()): floor holding every target that the rest of the level only
+    ///        reaches through the goalEntrance cell, which is not part of it. Filled in by parseLevel(), empty with
+    ///        goalEntrance -1 if the level has none.
+    Bitboard goalRoom;
+    int goalEntrance {-1};
+
+    int cell(int row, int col) const { return (row + 1) * width + (col + 1); }
+    int rowOf(int cell) const { return cell / width - 1; }
+    int colOf(int cell) const { return cell % width - 1; }
+    int cellCount() const { return width * height; }
+
+    /// @brief Index offset of one step in the given direction.
+    int offset(Direction dir) const {
+        switch (dir) {
+            case Direction::Up:    return width;
+            case Direction::Down:  return -width;
+            case Direction::Left:  return -1;
+            default:               return 1;
+        }
+    }
+
+    bool isWall(int cell) const { return walls.test(cell); }
+    bool isTarget(int cell) const { return targets.test(cell); }
+    bool isDead(int cell) const { return dead.test(cell); }
+};
+
+/// @brief Reads a level in the res/maps.txt format from a stream.
+/// @details Skips ahead to the line starting with the level number, then reads map rows until the next level
+///          header, a comment or the end of the stream. Tile legend:
+///          _ floor, X wall, * box, ! target, @ player, $ box on target, + player on target.
+/// @param in The stream to read from
+/// @param id The number of the level to read
+/// @param level Filled in on success
+/// @return true if the level was found, fits in MAX_CELLS and contains a player, false otherwise
+bool parseLevel(std::istream &in, int id, Level &level);
+
+/// @brief Builds a level from its map rows in the res/maps.txt legend, row 0 first (rendered at the bottom).
+/// @details Short rows are filled out with walls. Fills in the dead squares, tunnels and goal room.
+/// @param closeOutside Turn the floor the player could not reach even with every box gone into wall, for formats
+///                     that write the outside of a level as floor (XSB)
+/// @return true if the level fits in MAX_CELLS and contains a player
+bool buildLevel(const std::vector<std::string> &rows, int id, Level &level, bool closeOutside = false);
+
+/// @brief Floor cells from which a box can never be pushed onto any target.
+/// @details Found by pulling a box backwards from every target: pulling needs the cell behind the box and the one
+///          behind that to be floor. Every floor cell no pull reaches is dead. One pass over the grid, so it is
+///          cheap enough to run on every level load.
+Bitboard deadSquares(const Level &level);
+
+/// @brief Floor cells with walls on both sides across an axis: 0 for walls left and right, 1 for above and below.
+/// @details A box pushed along such a cell can only carry on or come back, the player behind it cannot pass.
+Bitboard tunnelCells(const Level &level, int axis);
+
+/// @brief The smallest floor area holding every target that is joined to the rest of the level by a single
+///        entrance cell, empty if there is none.
+/// @details The area must hold no box and not the player, the entrance must touch it on one side only and have
+///          floor on the opposite side (so a box can be pushed in), and the level must have as many boxes as
+///          targets, so the room is exactly filled in the end. One flood fill per floor cell and side.
+Bitboard findGoalRoom(const Level &level, int &entrance);
+
+/// @brief Writes a position in the res/maps.txt format, first row first ('+' for the player on a target).
+std::string boardToText(const Level &level, const Bitboard &boxes, int player);
+
+/// @brief The numbers of every level in a level file (maps or XSB format, see LevelPack), in file order.
+std::vector<int> listLevels(const std::string &path);
+
+/// @brief Opens a level file and loads one level from it. Code loading several levels of a file should open a
+///        LevelPack once instead.
+/// @return true if the level was loaded, false otherwise
+bool loadLevel(const std::string &path, int id, Level &level);
+
+/// @brief Every level of a level file, in file order, from a single LevelPack.
+/// @param invalid If given, receives the numbers of the levels that could not be loaded
+/// @return false if the file could not be opened
+bool loadLevels(const std::string &path, std::vector<Level> &levels, std::vector<int> *invalid = nullptr);
+
+#endif //SOKOBAN_LEVEL_H
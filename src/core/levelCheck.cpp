@@ -0,0 +1,234 @@
+#include "levelCheck.h"
+
+#include <algorithm>
+#include <cctype>
+
+using std::string, std::vector;
+
+namespace {
+    // A cell as written: its tile in the XSB legend ('?' if the character is in neither legend) and where it is
+    struct RawCell {
+        char tile;
+        char written;
+        int line, column;
+    };
+
+    char mapsTile(char c) {
+        switch (c) {
+            case '_': return ' ';
+            case 'X': return '#';
+            case '*': return '$';
+            case '!': return '.';
+            case '$': return '*';
+            case '@': return '@';
+            case '+': return '+';
+            default:  return '?';
+        }
+    }
+
+    char xsbTile(char c) {
+        switch (c) {
+            case '-':
+            case '_': return ' ';
+            case ' ':
+            case '#':
+            case '$':
+            case '.':
+            case '*':
+            case '@':
+            case '+': return c;
+            default:  return '?';
+        }
+    }
+
+    // The rows of a level in file order. Maps: the lines after the header. XSB: the board lines, run lengths
+    // expanded and '|' starting a new row.
+    vector<vector<RawCell>> rawRows(const LevelPack &pack, int index) {
+        const string text = pack.text(index);
+        const bool xsb = pack.format() == LevelFormat::Xsb;
+        vector<vector<RawCell>> rows;
+        int line = pack.line(index);
+        size_t start = 0;
+        if (!xsb) {
+            // skip the header
+            start = text.find('\n');
+            start = start == string::npos ? text.size() : start + 1;
+            ++line;
+        }
+        for (; start < text.size(); ++line) {
+            size_t end = text.find('\n', start);
+            if (end == string::npos)
+                end = text.size();
+            rows.emplace_back();
+            int count = 0;
+            for (size_t i = start; i < end; ++i) {
+                const char c = text[i];
+                const int column = (int)(i - start) + 1;
+                if (c == '\r')
+                    continue;
+                if (xsb && isdigit(static_cast<unsigned char>(c))) {
+                    count = count * 10 + (c - '0');
+                    continue;
+                }
+                if (xsb && c == '|') {
+                    rows.emplace_back();
+                    count = 0;
+                    continue;
+                }
+                const RawCell cell {xsb ? xsbTile(c) : mapsTile(c), c, line, column};
+                rows.back().insert(rows.back().end(), count > 0 ? count : 1, cell);
+                count = 0;
+            }
+            start = end + 1;
+        }
+        while (!rows.empty() && rows.back().empty())
+            rows.pop_back();
+        return rows;
+    }
+
+    string at(const RawCell &cell) {
+        return "line " + std::to_string(cell.line) + " column " + std::to_string(cell.column);
+    }
+}
+
+std::vector<Diagnostic> checkLevel(const LevelPack &pack, int index, Level &level, bool &loaded) {
+    loaded = false;
+    vector<Diagnostic> found;
+    const int firstLine = pack.line(index);
+    auto report = [&](int line, int column, bool error, const string &message) {
+        found.push_back({line, column, error, message});
+    };
+    auto reportAt = [&](const RawCell &cell, bool error, const string &message) {
+        report(cell.line, cell.column, error, message);
+    };
+
+    const vector<vector<RawCell>> rows = rawRows(pack, index);
+    if (rows.empty()) {
+        report(firstLine, 0, true, "the level has no map");
+        return found;
+    }
+    int cols = 0;
+    for (const auto &row : rows)
+        cols = std::max(cols, (int)row.size());
+
+    // legend, player, counts
+    const RawCell *player = nullptr;
+    int boxes = 0, targets = 0;
+    bool valid = true;
+    for (const auto &row : rows) {
+        for (const RawCell &cell : row) {
+            switch (cell.tile) {
+                case '?': {
+                    reportAt(cell, true, string("invalid character '") + cell.written + "'");
+                    valid = false;
+                    break;
+                }
+                case '@':
+                case '+': {
+                    if (player) {
+                        reportAt(cell, true, "a second player, the first is at " + at(*player));
+                        valid = false;
+                    } else {
+                        player = &cell;
+                    }
+                    break;
+                }
+                default: break;
+            }
+            boxes += cell.tile == '$' || cell.tile == '*';
+            targets += cell.tile == '.' || cell.tile == '*' || cell.tile == '+';
+        }
+    }
+    if (!player) {
+        report(firstLine, 0, true, "the level has no player");
+        valid = false;
+    }
+    if (boxes != targets) {
+        report(firstLine, 0, true, std::to_string(boxes) + " boxes but " + std::to_string(targets) + " targets");
+        valid = false;
+    } else if (boxes == 0) {
+        report(firstLine, 0, true, "the level has no boxes");
+        valid = false;
+    }
+    if ((cols + 2) * ((int)rows.size() + 2) > MAX_CELLS) {
+        report(firstLine, 0, true, "too large: " + std::to_string(cols) + "x" + std::to_string(rows.size()) +
+                                   ", the board holds " + std::to_string(MAX_CELLS) + " cells with its wall ring");
+        valid = false;
+    }
+
+    // Everything the player could walk to with the boxes out of the way. Reaching the edge of the map, or a cell
+    // past the end of a short row, means the walls do not close the level.
+    if (player) {
+        vector<vector<bool>> seen(rows.size());
+        for (size_t r {0}; r < rows.size(); ++r)
+            seen[r].assign(rows[r].size(), false);
+        vector<std::pair<int, int>> stack;
+        for (size_t r {0}; r < rows.size(); ++r) {
+            for (size_t c {0}; c < rows[r].size(); ++c) {
+                if (&rows[r][c] == player) {
+                    seen[r][c] = true;
+                    stack.emplace_back((int)r, (int)c);
+                }
+            }
+        }
+        const RawCell *leak = nullptr;
+        while (!stack.empty()) {
+            const auto [r, c] = stack.back();
+            stack.pop_back();
+            const int steps[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            for (const auto &step : steps) {
+                const int nr = r + step[0], nc = c + step[1];
+                if (nr < 0 || nr >= (int)rows.size() || nc < 0 || nc >= (int)rows[nr].size()) {
+                    if (!leak)
+                        leak = &rows[r][c];
+                    continue;
+                }
+                if (seen[nr][nc] || rows[nr][nc].tile == '#')
+                    continue;
+                seen[nr][nc] = true;
+                stack.emplace_back(nr, nc);
+            }
+        }
+        if (leak) {
+            reportAt(*leak, true, "the level is not closed: the player can walk off the map here");
+            valid = false;
+        }
+        for (size_t r {0}; r < rows.size(); ++r) {
+            for (size_t c {0}; c < rows[r].size(); ++c) {
+                const char tile = rows[r][c].tile;
+                if (seen[r][c])
+                    continue;
+                if (tile == '$') {
+                    reportAt(rows[r][c], true, "the player can never get to this box");
+                    valid = false;
+                } else if (tile == '.') {
+                    reportAt(rows[r][c], true, "the player can never get to this target");
+                    valid = false;
+                }
+            }
+        }
+    }
+    if (!valid) {
+        std::stable_sort(found.begin(), found.end(), [](const Diagnostic &a, const Diagnostic &b) {
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+        return found;
+    }
+
+    // the text is sound, so loading it only does what the checks above allow
+    loaded = pack.load(index, level);
+    if (!loaded) {
+        report(firstLine, 0, true, "the level does not load");
+        return found;
+    }
+    const bool flipped = pack.format() == LevelFormat::Xsb;
+    for (size_t r {0}; r < rows.size(); ++r) {
+        for (size_t c {0}; c < rows[r].size(); ++c) {
+            const int row = flipped ? (int)rows.size() - 1 - (int)r : (int)r;
+            const int cell = level.cell(row, (int)c);
+            if (rows[r][c].tile == '$' && level.isDead(cell))
+                reportAt(rows[r][c], true, "this box starts on a dead square, it can never reach a target");
+        }
+    }
+    return found;
+}
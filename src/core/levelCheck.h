@@ -0,0 +1,41 @@
+#ifndef SOKOBAN_LEVEL_CHECK_H
+#define SOKOBAN_LEVEL_CHECK_H
+
+#include <string>
+#include <vector>
+
+#include "level.h"
+#include "levelPack.h"
+
+/// @brief A problem found in a level, at a position of the level file.
+struct Diagnostic {
+    /// @brief Line and column in the file, from 1. The column is 0 for problems of the level as a whole.
+    int line {0}, column {0};
+
+    /// @brief Errors make a level unplayable or unwinnable, warnings only suspicious.
+    bool error {true};
+
+    std::string message;
+};
+
+/**
+ * @brief Checks the structure of the level at index of a text pack.
+ * @details Works on the text as written, so every problem points at its line and column (in run-length encoded
+ *          XSB rows, the column of the character that produced the cell):
+ *
+ *          - characters outside the legend of the pack's format
+ *          - no player, or more than one
+ *          - box and target counts that differ, or no boxes at all
+ *          - floor the player can walk to at the edge of the map or beside a short row: the level is not closed
+ *          - boxes and targets the player can never get to, even with every box out of the way
+ *          - a level too large for the board (MAX_CELLS with its wall ring)
+ *          - boxes that start on a dead square (see deadSquares()), so can never reach a target
+ *
+ *          Messages are not printed. Solvability is left to the caller, it needs a search budget.
+ * @param level Filled in if the level loads, so the caller can go on to solve it
+ * @param loaded Set to whether it did: only levels without structural errors are loaded
+ * @return the problems found, in file order; empty if the level is fine
+ */
+std::vector<Diagnostic> checkLevel(const LevelPack &pack, int index, Level &level, bool &loaded);
+
+#endif //SOKOBAN_LEVEL_CHECK_H
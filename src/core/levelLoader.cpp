@@ -0,0 +1,102 @@
+#include "levelLoader.h"
+
+#include <algorithm>
+
+LevelLoader::LevelLoader(const LevelPack &pack) : pack(pack) {
+    // started here rather than in the initializer list, so every member it reads is initialized
+    worker = std::thread(&LevelLoader::run, this);
+}
+
+LevelLoader::~LevelLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void LevelLoader::prefetch(int id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (id == loading || ready.count(id) || std::find(queue.begin(), queue.end(), id) != queue.end())
+            return;
+        queue.push_back(id);
+    }
+    wake.notify_one();
+}
+
+bool LevelLoader::get(int id, Level &level) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // the worker is on it, waiting is shorter than starting over
+        loaded.wait(lock, [&] { return loading != id; });
+        auto found = ready.find(id);
+        if (found != ready.end()) {
+            level = found->second;
+            readyOrder.erase(std::find(readyOrder.begin(), readyOrder.end(), id));
+            readyOrder.push_back(id);
+            return true;
+        }
+        queue.erase(std::remove(queue.begin(), queue.end(), id), queue.end());
+    }
+    if (!pack.loadId(id, level))
+        return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    store(id, level);
+    return true;
+}
+
+void LevelLoader::store(int id, const Level &level) {
+    if (ready.count(id)) {
+        readyOrder.erase(std::find(readyOrder.begin(), readyOrder.end(), id));
+    } else if (readyOrder.size() >= KEEP) {
+        ready.erase(readyOrder.front());
+        readyOrder.pop_front();
+    }
+    ready[id] = level;
+    readyOrder.push_back(id);
+}
+
+void LevelLoader::clear() {
+    std::unique_lock<std::mutex> lock(mutex);
+    // the level in hand is read from the pack, which may be about to change
+    loaded.wait(lock, [this] { return loading < 0; });
+    ++generation;
+    queue.clear();
+    ready.clear();
+    readyOrder.clear();
+}
+
+void LevelLoader::modify(const std::function<std::vector<int>()> &change) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // the worker only takes a level off the queue with the lock held, so it stays idle until this returns
+    loaded.wait(lock, [this] { return loading < 0; });
+    for (int id : change()) {
+        if (ready.erase(id))
+            readyOrder.erase(std::find(readyOrder.begin(), readyOrder.end(), id));
+    }
+}
+
+void LevelLoader::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !queue.empty() || quit; });
+        if (quit)
+            return;
+        const int id = queue.front();
+        queue.pop_front();
+        const uint64_t jobGeneration = generation;
+        loading = id;
+        lock.unlock();
+
+        Level level;
+        const bool valid = pack.loadId(id, level);
+
+        lock.lock();
+        loading = -1;
+        if (valid && jobGeneration == generation)
+            store(id, level);
+        loaded.notify_all();
+    }
+}
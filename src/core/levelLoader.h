@@ -0,0 +1,76 @@
+#ifndef SOKOBAN_LEVEL_LOADER_H
+#define SOKOBAN_LEVEL_LOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "level.h"
+#include "levelPack.h"
+
+/**
+ * @brief The LevelLoader class.
+ * @details Loads levels of a pack on a worker thread ahead of time, so the caller (the render loop) does not parse
+ *          a level, or work out its dead squares, tunnels and goal room, when it switches to it: prefetch() queues
+ *          a level and returns, get() hands over the loaded copy. A level that was not prefetched is loaded by
+ *          get() on the calling thread, as before.
+ *
+ *          Loaded levels are kept in a small LRU cache, prefetched ones and those get() loaded itself alike, so
+ *          going back to a recently played level never parses it again. The pack is read from the worker, so call
+ *          clear() before reopening it: that waits for the level in hand and drops everything loaded from the old
+ *          pack. A pack reloaded after an edit goes through modify() instead, which keeps the levels it did not
+ *          touch.
+ */
+class LevelLoader {
+public:
+    explicit LevelLoader(const LevelPack &pack);
+    ~LevelLoader();
+
+    LevelLoader(const LevelLoader &) = delete;
+    LevelLoader &operator=(const LevelLoader &) = delete;
+
+    /// @brief Queues a level for the worker, unless it is loaded or queued already.
+    void prefetch(int id);
+
+    /// @brief The level with this id: the cached copy if there is one, after waiting for the worker if it is
+    ///        loading it right now, else loaded on the calling thread (and cached).
+    /// @return false if the level is not in the pack or does not load
+    bool get(int id, Level &level);
+
+    /// @brief Waits for the worker to finish the level in hand and drops every level loaded or queued.
+    void clear();
+
+    /// @brief Changes the pack in place (see LevelPack::reload()) while the worker is idle.
+    /// @details change is run with the worker held off and returns the ids of the levels it changed: only those
+    ///          are dropped from the cache, every other level stays loaded.
+    void modify(const std::function<std::vector<int>()> &change);
+
+private:
+    void run();
+
+    /// @brief Caches a loaded level as the most recently used one, dropping the least recently used if full.
+    void store(int id, const Level &level);
+
+    // levels kept in the cache
+    static constexpr size_t KEEP = 8;
+
+    const LevelPack &pack;
+
+    std::mutex mutex;
+    std::condition_variable wake;   // the worker: a level was queued, or quit
+    std::condition_variable loaded; // get(): the worker finished a level
+    std::thread worker;
+    bool quit {false};
+
+    std::deque<int> queue;
+    int loading {-1};               // level the worker is loading, -1 if none
+    uint64_t generation {0};        // bumped by clear(), levels loaded before it are dropped
+    std::unordered_map<int, Level> ready;
+    std::deque<int> readyOrder;     // least recently used first
+};
+
+#endif //SOKOBAN_LEVEL_LOADER_H
@@ -0,0 +1,394 @@
+#include "levelPack.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+using std::string, std::vector, std::cout, std::endl;
+
+namespace {
+    // Calls visit(line, start, end, number) for every line of text from the line starting at from, numbered
+    // first: the line without its line ending, where it starts, where the next line starts and its number. Stops
+    // early if visit returns false.
+    template<typename Visit>
+    void forEachLine(const string &text, size_t from, int first, Visit visit) {
+        size_t start = from;
+        for (int number = first; start < text.size(); ++number) {
+            size_t end = text.find('\n', start);
+            end = end == string::npos ? text.size() : end + 1;
+            size_t length = end - start;
+            while (length > 0 && (text[start + length - 1] == '\n' || text[start + length - 1] == '\r'))
+                --length;
+            if (!visit(text.substr(start, length), start, end, number))
+                return;
+            start = end;
+        }
+    }
+
+    int countLines(const string &text, size_t from, size_t to) {
+        return (int)std::count(text.begin() + (std::ptrdiff_t)from, text.begin() + (std::ptrdiff_t)to, '\n');
+    }
+
+    bool readFile(const string &path, string &text) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            cout << "could not open " << path << endl;
+            return false;
+        }
+        in.seekg(0, std::ios::end);
+        text.assign((size_t)in.tellg(), '\0');
+        in.seekg(0);
+        in.read(&text[0], (std::streamsize)text.size());
+        if (!in) {
+            cout << "could not read " << path << endl;
+            return false;
+        }
+        return true;
+    }
+
+    string trim(const string &text) {
+        const size_t first = text.find_first_not_of(" \t");
+        if (first == string::npos)
+            return string();
+        return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+    }
+
+    // A board row holds only XSB tiles, run lengths and row separators, and at least one wall
+    bool isXsbRow(const string &line) {
+        if (line.find('#') == string::npos)
+            return false;
+        for (char c : line) {
+            if (!isdigit(static_cast<unsigned char>(c)) && !strchr(" #@+$*.-_|", c))
+                return false;
+        }
+        return true;
+    }
+
+    // "Key: value" lines after an XSB board, e.g. "Title: ...", "Author: ..."
+    bool isField(const string &line, string &key, string &value) {
+        const size_t colon = line.find(':');
+        if (colon == string::npos || colon == 0)
+            return false;
+        for (size_t i {0}; i < colon; ++i) {
+            if (!isalpha(static_cast<unsigned char>(line[i])))
+                return false;
+        }
+        key = line.substr(0, colon);
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)tolower(c); });
+        value = trim(line.substr(colon + 1));
+        return true;
+    }
+}
+
+LevelFormat formatOf(const std::string &path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == string::npos)
+        return LevelFormat::Maps;
+    string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return (char)tolower(c); });
+    return extension == "xsb" || extension == "sok" ? LevelFormat::Xsb : LevelFormat::Maps;
+}
+
+bool LevelPack::open(const std::string &path) {
+    sourcePath = path;
+    if (CompiledPack::isCompiled(path)) {
+        contents.clear();
+        entries.clear();
+        byId.clear();
+        levelFormat = LevelFormat::Compiled;
+        return compiled.open(path);
+    }
+    string text;
+    if (!readFile(path, text))
+        return false;
+    openText(std::move(text), formatOf(path));
+    return true;
+}
+
+bool LevelPack::reload(std::vector<int> &changed) {
+    changed.clear();
+    if (levelFormat != LevelFormat::Compiled && !CompiledPack::isCompiled(sourcePath)) {
+        string text;
+        if (!readFile(sourcePath, text))
+            return false;
+        update(std::move(text), changed);
+        return true;
+    }
+    // a compiled pack has no text to compare, every level may have changed
+    for (int i {0}; i < size(); ++i)
+        changed.push_back(id(i));
+    if (!open(sourcePath))
+        return false;
+    for (int i {0}; i < size(); ++i)
+        changed.push_back(id(i));
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return true;
+}
+
+void LevelPack::openText(std::string text, LevelFormat format) {
+    compiled.close();
+    contents = std::move(text);
+    levelFormat = format;
+    index();
+}
+
+void LevelPack::index() {
+    entries.clear();
+    scan(0, 1, nullptr);
+    indexIds();
+}
+
+void LevelPack::indexIds() {
+    byId.clear();
+    for (int i {0}; i < (int)entries.size(); ++i)
+        byId.emplace(entries[i].id, i); // the first of two levels with one number wins, as with parseLevel()
+}
+
+void LevelPack::scan(size_t from, int line, const std::function<bool(size_t)> &stop) {
+    if (levelFormat == LevelFormat::Xsb)
+        scanXsb(from, line, stop);
+    else
+        scanMaps(from, line, stop);
+}
+
+void LevelPack::scanMaps(size_t from, int firstLine, const std::function<bool(size_t)> &stop) {
+    // a header ("1 # Level 1 : ...") starts a level, its map rows run to the next header, comment or empty line
+    bool inLevel = false;
+    forEachLine(contents, from, firstLine, [&](const string &line, size_t start, size_t end, int number) {
+        if (!line.empty() && isdigit(static_cast<unsigned char>(line[0]))) {
+            if (stop && stop(start))
+                return false;
+            LevelEntry entry;
+            entry.id = (int)strtol(line.c_str(), nullptr, 10);
+            const size_t hash = line.find('#');
+            entry.title = hash == string::npos ? string() : trim(line.substr(hash + 1));
+            entry.offset = start;
+            entry.length = end - start;
+            entry.line = number;
+            entries.push_back(entry);
+            inLevel = true;
+        } else if (inLevel && !line.empty() && line[0] != '#') {
+            entries.back().length = end - entries.back().offset;
+        } else {
+            inLevel = false;
+        }
+        return true;
+    });
+}
+
+void LevelPack::scanXsb(size_t from, int firstLine, const std::function<bool(size_t)> &stop) {
+    // A level is a run of board rows. Its title is a "Title:" field after the board, or else the last line of
+    // free text before it (";" comment markers stripped). Other fields and comments are skipped.
+    bool inBoard = false;
+    bool titled = false;
+    string pending;
+    forEachLine(contents, from, firstLine, [&](const string &line, size_t start, size_t end, int number) {
+        if (isXsbRow(line)) {
+            if (!inBoard) {
+                if (stop && stop(start))
+                    return false;
+                LevelEntry entry;
+                entry.id = (int)entries.size() + 1;
+                entry.title = pending;
+                entry.offset = start;
+                entry.line = number;
+                entries.push_back(entry);
+                pending.clear();
+                titled = false;
+                inBoard = true;
+            }
+            entries.back().length = end - entries.back().offset;
+            return true;
+        }
+        inBoard = false;
+        const string text = trim(line);
+        string key, value;
+        if (isField(text, key, value)) {
+            if (key == "title" && !entries.empty() && !titled) {
+                entries.back().title = value;
+                titled = true;
+            }
+        } else if (!text.empty()) {
+            const size_t first = text.find_first_not_of("; \t");
+            pending = first == string::npos ? string() : text.substr(first);
+        }
+        return true;
+    });
+}
+
+void LevelPack::update(std::string updated, std::vector<int> &changed) {
+    // the changed bytes: [prefix, oldEnd) of the old text became [prefix, newEnd) of the new one
+    const string old = std::exchange(contents, std::move(updated));
+    const string &text = contents;
+    const size_t common = std::min(old.size(), text.size());
+    const size_t prefix = (size_t)(std::mismatch(old.begin(), old.begin() + (std::ptrdiff_t)common,
+                                                 text.begin()).first - old.begin());
+    size_t suffix = 0;
+    while (suffix < common - prefix && old[old.size() - 1 - suffix] == text[text.size() - 1 - suffix])
+        ++suffix;
+    if (prefix == old.size() && prefix == text.size())
+        return;
+    const size_t oldEnd = old.size() - suffix, newEnd = text.size() - suffix;
+    const std::ptrdiff_t delta = (std::ptrdiff_t)text.size() - (std::ptrdiff_t)old.size();
+    const int lineDelta = countLines(text, prefix, newEnd) - countLines(old, prefix, oldEnd);
+
+    // Levels before the last one that starts ahead of the change stay as they are. The scan starts again right
+    // after the board of the last of them, where it holds no state from earlier lines; that level is still the
+    // one an XSB "Title:" field there names.
+    size_t keep = 0;
+    while (keep + 1 < entries.size() && entries[keep + 1].offset < prefix)
+        ++keep;
+    const string keptTitle = keep > 0 ? entries[keep - 1].title : string();
+    size_t from = 0;
+    int line = 1;
+    if (keep > 0) {
+        const LevelEntry &last = entries[keep - 1];
+        from = last.offset + last.length;
+        line = last.line + countLines(old, last.offset, from);
+    }
+
+    // The scan stops at a level that starts after the change where the old index had one too: from there on the
+    // old entries only move. For XSB it goes on to the second such level, the title of the first may come from
+    // free text inside the change.
+    const std::vector<LevelEntry> oldEntries(entries.begin() + (std::ptrdiff_t)keep, entries.end());
+    entries.resize(keep);
+    size_t resume = oldEntries.size();
+    int matches = 0;
+    const int needed = levelFormat == LevelFormat::Xsb ? 2 : 1;
+    scan(from, line, [&](size_t offset) {
+        if (offset < newEnd)
+            return false;
+        const size_t oldOffset = (size_t)((std::ptrdiff_t)offset - delta);
+        auto found = std::lower_bound(oldEntries.begin(), oldEntries.end(), oldOffset,
+                                      [](const LevelEntry &entry, size_t at) { return entry.offset < at; });
+        if (found == oldEntries.end() || found->offset != oldOffset || oldOffset < oldEnd)
+            return false;
+        if (++matches < needed)
+            return false;
+        resume = (size_t)(found - oldEntries.begin());
+        return true;
+    });
+
+    // what the scan found against what it replaced, by id; an XSB id is a position, so a level added or removed
+    // renumbers every level after it
+    if (keep > 0 && entries[keep - 1].title != keptTitle)
+        changed.push_back(entries[keep - 1].id);
+    const size_t scanned = entries.size() - keep;
+    std::unordered_map<int, const LevelEntry *> before;
+    for (size_t i {0}; i < resume; ++i)
+        before.emplace(oldEntries[i].id, &oldEntries[i]);
+    for (size_t i = keep; i < entries.size(); ++i) {
+        auto was = before.find(entries[i].id);
+        if (was == before.end() || was->second->title != entries[i].title ||
+            was->second->length != entries[i].length ||
+            old.compare(was->second->offset, was->second->length, contents, entries[i].offset, entries[i].length))
+            changed.push_back(entries[i].id);
+        if (was != before.end())
+            before.erase(was);
+    }
+    for (const auto &gone : before)
+        changed.push_back(gone.first);
+    const int idDelta = levelFormat == LevelFormat::Xsb ? (int)scanned - (int)resume : 0;
+    for (size_t i = resume; i < oldEntries.size(); ++i) {
+        LevelEntry entry = oldEntries[i];
+        entry.offset = (size_t)((std::ptrdiff_t)entry.offset + delta);
+        entry.line += lineDelta;
+        if (idDelta != 0) {
+            changed.push_back(entry.id);
+            entry.id += idDelta;
+            changed.push_back(entry.id);
+        }
+        entries.push_back(entry);
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    indexIds();
+}
+
+std::string LevelPack::title(int index) const {
+    return levelFormat == LevelFormat::Compiled ? compiled.title(index) : entries[index].title;
+}
+
+std::string LevelPack::text(int index) const {
+    if (levelFormat == LevelFormat::Compiled)
+        return string();
+    return contents.substr(entries[index].offset, entries[index].length);
+}
+
+int LevelPack::find(int id) const {
+    if (levelFormat == LevelFormat::Compiled)
+        return compiled.find(id);
+    auto found = byId.find(id);
+    return found == byId.end() ? -1 : found->second;
+}
+
+bool LevelPack::load(int index, Level &level) const {
+    if (levelFormat == LevelFormat::Compiled)
+        return compiled.load(index, level);
+    const LevelEntry &entry = entries[index];
+    if (levelFormat == LevelFormat::Maps) {
+        std::istringstream in(text(index));
+        return parseLevel(in, entry.id, level);
+    }
+    vector<string> rows;
+    if (!xsbToRows(text(index), rows)) {
+        cout << "invalid character in level " << entry.id << " (line " << entry.line << ")" << endl;
+        return false;
+    }
+    return buildLevel(rows, entry.id, level, true);
+}
+
+bool LevelPack::loadId(int id, Level &level) const {
+    const int index = find(id);
+    if (index < 0) {
+        cout << "level " << id << " not found" << endl;
+        return false;
+    }
+    return load(index, level);
+}
+
+bool xsbToRows(const std::string &board, std::vector<std::string> &rows) {
+    rows.assign(1, string());
+    int count = 0;
+    for (char c : board) {
+        if (isdigit(static_cast<unsigned char>(c))) {
+            count = count * 10 + (c - '0');
+            continue;
+        }
+        char tile;
+        switch (c) {
+            case '\r': continue;
+            case '\n':
+            case '|': {
+                rows.emplace_back();
+                count = 0;
+                continue;
+            }
+            case '#': tile = 'X'; break;
+            case ' ':
+            case '-':
+            case '_': tile = '_'; break;
+            case '$': tile = '*'; break;
+            case '.': tile = '!'; break;
+            case '*': tile = '$'; break;
+            case '@': tile = '@'; break;
+            case '+': tile = '+'; break;
+            default: return false;
+        }
+        rows.back().append(count > 0 ? count : 1, tile);
+        count = 0;
+    }
+    while (!rows.empty() && rows.back().empty())
+        rows.pop_back();
+    // XSB starts at the top, Level row 0 is at the bottom
+    std::reverse(rows.begin(), rows.end());
+    return true;
+}
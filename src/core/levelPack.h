@@ -0,0 +1,125 @@
+#ifndef SOKOBAN_LEVEL_PACK_H
+#define SOKOBAN_LEVEL_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compiledPack.h"
+#include "level.h"
+
+/// @brief How the levels of a file are written.
+enum class LevelFormat : uint8_t {
+    Maps,       // res/maps.txt: numbered headers, X _ * ! @ $ legend, first line rendered at the bottom
+    Xsb,        // the common XSB / .sok format: # - $ . @ * +, first line at the top
+    Compiled    // binary, written by sokoban-levelc (see CompiledPack)
+};
+
+/// @brief LevelFormat::Xsb for .xsb and .sok files, LevelFormat::Maps for anything else. Compiled packs are
+///        recognized by their contents, not their name.
+LevelFormat formatOf(const std::string &path);
+
+/// @brief Where one level sits in the text of a pack.
+struct LevelEntry {
+    /// @brief The number in the level header for the maps format, the position in the pack (from 1) for XSB.
+    int id {0};
+
+    /// @brief The header comment for the maps format, the "Title:" field or the line before the board for XSB.
+    std::string title;
+
+    /// @brief The level's text: the header and map rows for the maps format, the board rows for XSB.
+    size_t offset {0}, length {0};
+
+    /// @brief Line of the text the level starts on, from 1.
+    int line {0};
+};
+
+/**
+ * @brief The LevelPack class.
+ * @details A level file read into memory and indexed in a single pass: the index records the id, title and
+ *          text range of every level, so loading one parses that level's text and nothing else. Opening a pack of
+ *          thousands of levels costs one scan of the file; each load after that is linear in the level's size.
+ *
+ *          A compiled pack (sokoban-levelc) is mapped instead and needs no index at all: opening and loading
+ *          cost the same whatever the size of the pack. Its levels are in order of id.
+ *
+ *          XSB boards may be run-length encoded ("4#" for "####", '|' for a new row), rows are flipped on load
+ *          so the first line ends up at the top of the screen as the maps format has it, and the floor outside
+ *          the walls (which XSB writes as spaces) is turned into wall. XSB levels that do not fit in MAX_CELLS
+ *          are indexed but fail to load.
+ */
+class LevelPack {
+public:
+    /// @brief Reads and indexes a file (or maps a compiled pack), replacing what was open before.
+    /// @return false if the file could not be read
+    bool open(const std::string &path);
+
+    /// @brief Indexes levels held in memory, replacing what was open before.
+    void openText(std::string text, LevelFormat format);
+
+    /**
+     * @brief Reads the file open() opened again, after it was edited.
+     * @details The new text is compared with the old one and only the part of the index from the last level
+     *          before the first changed byte to the first level after the last one is scanned again; the levels
+     *          after it keep their entries, moved by the change in length. A compiled pack is reopened whole.
+     * @param changed Set to the ids of the levels that were edited, added or removed, in order. For XSB, where
+     *                ids are positions, adding or removing a level changes every id after it.
+     * @return false if the file could not be read
+     */
+    bool reload(std::vector<int> &changed);
+
+    int size() const { return levelFormat == LevelFormat::Compiled ? compiled.size() : (int)entries.size(); }
+    bool empty() const { return size() == 0; }
+    LevelFormat format() const { return levelFormat; }
+
+    /// @brief Id and title of the level at index (see LevelEntry).
+    int id(int index) const { return levelFormat == LevelFormat::Compiled ? compiled.id(index) : entries[index].id; }
+    std::string title(int index) const;
+
+    /// @brief Line the level at index starts on, 0 for a compiled pack.
+    int line(int index) const { return levelFormat == LevelFormat::Compiled ? 0 : entries[index].line; }
+
+    /// @return the index of the level with this id, -1 if there is none
+    int find(int id) const;
+
+    /// @brief Parses the level at index (see parseLevel() and buildLevel()), or copies it out of a compiled pack.
+    /// @return false if the level is invalid or too large
+    bool load(int index, Level &level) const;
+
+    /// @brief Loads the level with this id.
+    /// @return false if there is no such level or it is invalid
+    bool loadId(int id, Level &level) const;
+
+    /// @brief The text of the level at index, as it is in the file (empty for a compiled pack).
+    std::string text(int index) const;
+
+private:
+    void index();
+    void indexIds();
+
+    /// @brief Indexes the levels of contents from the line starting at from (numbered line), appending to entries.
+    ///        stop is asked before each new level, with its offset, whether to end the scan there.
+    void scan(size_t from, int line, const std::function<bool(size_t)> &stop);
+    void scanMaps(size_t from, int firstLine, const std::function<bool(size_t)> &stop);
+    void scanXsb(size_t from, int firstLine, const std::function<bool(size_t)> &stop);
+
+    /// @brief Replaces contents with text, indexing again only the levels around what changed (see reload()).
+    void update(std::string text, std::vector<int> &changed);
+
+    std::string sourcePath;
+    std::string contents;
+    LevelFormat levelFormat {LevelFormat::Maps};
+    std::vector<LevelEntry> entries;
+    std::unordered_map<int, int> byId;
+    CompiledPack compiled;
+};
+
+/// @brief Turns the board rows of an XSB level (first line first, possibly run-length encoded) into rows in the
+///        maps legend, first row rendered at the bottom, ready for buildLevel().
+/// @return false if a row holds a character that is not in the XSB legend
+bool xsbToRows(const std::string &board, std::vector<std::string> &rows);
+
+#endif //SOKOBAN_LEVEL_PACK_H
@@ -0,0 +1,66 @@
+#include "levelWatcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // how often the modification time is compared when there is no inotify
+    constexpr std::chrono::milliseconds POLL_INTERVAL {500};
+}
+
+LevelWatcher::LevelWatcher(const std::string &path) : path(path) {
+    const std::filesystem::path file(path);
+    name = file.filename().string();
+    std::error_code error;
+    lastWrite = std::filesystem::last_write_time(file, error);
+    nextCheck = std::chrono::steady_clock::now() + POLL_INTERVAL;
+#ifdef __linux__
+    // the directory rather than the file: a file saved by rename is a new inode, a watch on the old one goes quiet
+    inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify >= 0) {
+        const std::string directory = file.has_parent_path() ? file.parent_path().string() : ".";
+        if (inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            close(inotify);
+            inotify = -1;
+        }
+    }
+#endif
+}
+
+LevelWatcher::~LevelWatcher() {
+#ifdef __linux__
+    if (inotify >= 0)
+        close(inotify);
+#endif
+}
+
+bool LevelWatcher::changed() {
+#ifdef __linux__
+    if (inotify >= 0) {
+        bool written = false;
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(inotify, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t at {0}; at < length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + at);
+                if (event->len > 0 && name == event->name)
+                    written = true;
+                at += (ssize_t)sizeof(inotify_event) + event->len;
+            }
+        }
+        return written;
+    }
+#endif
+    const auto now = std::chrono::steady_clock::now();
+    if (now < nextCheck)
+        return false;
+    nextCheck = now + POLL_INTERVAL;
+    std::error_code error;
+    const auto written = std::filesystem::last_write_time(path, error);
+    if (error || written == lastWrite)
+        return false;
+    lastWrite = written;
+    return true;
+}
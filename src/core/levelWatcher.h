@@ -0,0 +1,38 @@
+#ifndef SOKOBAN_LEVEL_WATCHER_H
+#define SOKOBAN_LEVEL_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief The LevelWatcher class.
+ * @details Tells when a file has been written, so a level file can be reloaded while the game runs. On Linux it
+ *          watches the file's directory with inotify (non-blocking, so changed() only drains the events queued
+ *          since the last frame), which also sees editors that save by writing a new file and renaming it over
+ *          the old one. Elsewhere, or if inotify is not available, it compares the file's modification time
+ *          twice a second.
+ */
+class LevelWatcher {
+public:
+    explicit LevelWatcher(const std::string &path);
+    ~LevelWatcher();
+
+    LevelWatcher(const LevelWatcher &) = delete;
+    LevelWatcher &operator=(const LevelWatcher &) = delete;
+
+    /// @brief Whether the file was written (or replaced) since the last call. Never blocks, call it every frame.
+    bool changed();
+
+private:
+    std::string path;
+    std::string name;   // file name within its directory, what inotify events carry
+
+    int inotify {-1};   // the inotify descriptor, -1 when polling
+
+    // polling: the last modification time seen and when to look again
+    std::filesystem::file_time_type lastWrite;
+    std::chrono::steady_clock::time_point nextCheck;
+};
+
+#endif //SOKOBAN_LEVEL_WATCHER_H
@@ -0,0 +1,184 @@
+#include "macros.h"
+#include "zobrist.h"
+
+#include <algorithm>
+
+MacroMoves::MacroMoves(const Level &level, bool enabled) : level(level), enabled(enabled) {
+    if (!enabled || level.goalEntrance < 0)
+        return;
+    const int entrance = level.goalEntrance;
+    for (int d {0}; d < 4; ++d) {
+        if (level.goalRoom.test(entrance + level.offset(static_cast<Direction>(d))))
+            inward = static_cast<Direction>(d);
+    }
+
+    // deepest target first: the one furthest from the entrance that a box can still be pushed onto
+    Bitboard filled, left = level.targets;
+    while (left.any()) {
+        int distance[MAX_CELLS];
+        std::fill(distance, distance + MAX_CELLS, -1);
+        int queue[MAX_CELLS];
+        int head = 0, tail = 0;
+        distance[entrance] = 0;
+        queue[tail++] = entrance;
+        while (head < tail) {
+            const int cell = queue[head++];
+            for (int d {0}; d < 4; ++d) {
+                const int to = cell + level.offset(static_cast<Direction>(d));
+                if (level.goalRoom.test(to) && !filled.test(to) && distance[to] < 0) {
+                    distance[to] = distance[cell] + 1;
+                    queue[tail++] = to;
+                }
+            }
+        }
+        std::vector<int> candidates;
+        left.forEach([&](int target) {
+            if (distance[target] >= 0)
+                candidates.push_back(target);
+        });
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [&](int a, int b) { return distance[a] > distance[b]; });
+
+        bool placed = false;
+        for (int target : candidates) {
+            std::vector<Push> pushes = roomPushes(target, filled);
+            if (pushes.empty())
+                continue;
+            order.push_back(target);
+            filledBefore.push_back(filled);
+            fillPushes.push_back(std::move(pushes));
+            filled.set(target);
+            left.reset(target);
+            placed = true;
+            break;
+        }
+        if (!placed) {
+            // the greedy order got stuck, go without goal room macros rather than risk a wrong one
+            order.clear();
+            filledBefore.clear();
+            fillPushes.clear();
+            return;
+        }
+    }
+}
+
+std::vector<Push> MacroMoves::roomPushes(int target, const Bitboard &filled) const {
+    const int entrance = level.goalEntrance;
+    const int behind = entrance - level.offset(inward);
+
+    // the room as a level of its own: everything outside it and the filled targets are walls
+    Level room = level;
+    Bitboard open = level.goalRoom.andNot(filled);
+    open.set(entrance);
+    open.set(behind);
+    for (int cell {0}; cell < level.cellCount(); ++cell) {
+        if (!open.test(cell))
+            room.walls.set(cell);
+    }
+
+    // breadth-first over pushes of the one box, states are box cell and normalized player
+    struct State {
+        int box, player, parent;
+        Push push;
+    };
+    std::vector<State> states;
+    std::vector<uint8_t> seen(MAX_CELLS * MAX_CELLS);
+    Bitboard start;
+    start.set(entrance);
+    states.push_back({entrance, normalizedPlayer(room, start, behind), -1, {0, Direction::Up}});
+    seen[entrance * MAX_CELLS + states[0].player] = 1;
+    for (size_t head {0}; head < states.size(); ++head) {
+        const State state = states[head];
+        Bitboard box;
+        box.set(state.box);
+        const Bitboard reach = reachable(room, box, state.player);
+        for (int d {0}; d < 4; ++d) {
+            const auto dir = static_cast<Direction>(d);
+            const int delta = level.offset(dir);
+            const int to = state.box + delta;
+            if (!reach.test(state.box - delta) || room.isWall(to))
+                continue;
+            Bitboard moved;
+            moved.set(to);
+            const int player = normalizedPlayer(room, moved, state.box);
+            if (seen[to * MAX_CELLS + player])
+                continue;
+            seen[to * MAX_CELLS + player] = 1;
+            states.push_back({to, player, (int)head, {state.box, dir}});
+            if (to != target)
+                continue;
+            std::vector<Push> pushes;
+            for (int i = (int)states.size() - 1; states[i].parent >= 0; i = states[i].parent)
+                pushes.push_back(states[i].push);
+            std::reverse(pushes.begin(), pushes.end());
+            return pushes;
+        }
+    }
+    return {};
+}
+
+MacroMoves::End MacroMoves::apply(Bitboard &boxes, const Push &push, std::vector<Push> *pushes) const {
+    const int delta = level.offset(push.dir);
+    End end {push.box + delta, push.box, 1};
+    boxes.move(push.box, end.box);
+    if (pushes)
+        pushes->push_back(push);
+    if (!enabled)
+        return end;
+
+    // along a tunnel, for as long as the player is in it too
+    const int axis = push.dir == Direction::Up || push.dir == Direction::Down ? 0 : 1;
+    while (!level.isTarget(end.box) && level.tunnels[axis].test(end.box) && level.tunnels[axis].test(end.player)) {
+        const int next = end.box + delta;
+        if (level.isWall(next) || boxes.test(next) || level.isDead(next))
+            break;
+        if (pushes)
+            pushes->push_back({end.box, push.dir});
+        boxes.move(end.box, next);
+        end.player = end.box;
+        end.box = next;
+        ++end.pushes;
+    }
+
+    // in through the goal room entrance, onto the next target when the room is filled up to it
+    if (end.box != level.goalEntrance || push.dir != inward || order.empty())
+        return end;
+    const Bitboard inside = boxes & level.goalRoom;
+    const size_t step = inside.count();
+    if (step >= order.size() || inside != filledBefore[step])
+        return end;
+    const std::vector<Push> &fill = fillPushes[step];
+    boxes.move(end.box, order[step]);
+    if (pushes)
+        pushes->insert(pushes->end(), fill.begin(), fill.end());
+    end.box = order[step];
+    end.player = fill.back().box;
+    end.pushes += (int)fill.size();
+    return end;
+}
+
+SearchNode MacroMoves::child(const SearchNode &parent, uint32_t parentIndex, const Push &push) const {
+    if (!enabled)
+        return childNode(level, parent, parentIndex, push);
+    SearchNode child {};
+    child.boxes = parent.boxes;
+    const End end = apply(child.boxes, push, nullptr);
+    child.player = (uint16_t)normalizedPlayer(level, child.boxes, end.player);
+    child.boxHash = parent.boxHash ^ ZOBRIST.box[push.box] ^ ZOBRIST.box[end.box];
+    child.hash = child.boxHash ^ ZOBRIST.player[child.player];
+    child.parent = parentIndex;
+    child.pushBox = (uint16_t)push.box;
+    child.pushDir = push.dir;
+    child.depth = (uint16_t)(parent.depth + end.pushes);
+    return child;
+}
+
+std::vector<Push> MacroMoves::expand(const std::vector<Push> &firstPushes) const {
+    if (!enabled)
+        return firstPushes;
+    std::vector<Push> pushes;
+    Bitboard boxes = level.boxes;
+    for (const Push &push : firstPushes)
+        apply(boxes, push, &pushes);
+    return pushes;
+}
@@ -0,0 +1,65 @@
+#ifndef SOKOBAN_MACROS_H
+#define SOKOBAN_MACROS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "level.h"
+#include "nodeStore.h"
+#include "search.h"
+
+/**
+ * @brief The MacroMoves class.
+ * @details Turns single pushes into the longer moves they force, from the level features found by parseLevel():
+ *
+ *          - Tunnel: a box pushed along a one-wide tunnel (Level::tunnels) with the player in the tunnel behind it
+ *            is pushed on until it leaves the tunnel, reaches a target or is blocked. Stopping halfway only
+ *            blocks the tunnel.
+ *          - Goal room: a box pushed in through Level::goalEntrance goes straight to the next target of a fill
+ *            order worked out here, deepest target first, as long as the boxes already in the room sit on the
+ *            targets before it in that order. Each step of the order is checked to be pushable with the targets
+ *            before it filled, otherwise the level gets no goal room macros.
+ *
+ *          A search stores a macro move as a node with its first push and the depth of all its pushes; expand()
+ *          turns the first pushes of a solution back into every push. Macros cut nodes, but a search that counts
+ *          moves rather than pushes (BFS) is then only optimal in macro moves.
+ */
+class MacroMoves {
+public:
+    /// @param enabled false gives single pushes only, so callers need no separate path for macros off
+    MacroMoves(const Level &level, bool enabled);
+
+    /// @brief The node reached by the macro move that starts with push (a single push if none applies).
+    SearchNode child(const SearchNode &parent, uint32_t parentIndex, const Push &push) const;
+
+    /// @brief Every push of a solution stored as the first push of each macro move, from the start of the level.
+    std::vector<Push> expand(const std::vector<Push> &firstPushes) const;
+
+    /// @brief Cells in some tunnel, and the number of goal room targets with a fill order (0 if none).
+    int tunnelCells() const { return (level.tunnels[0] | level.tunnels[1]).count(); }
+    int goalRoomTargets() const { return (int)order.size(); }
+
+private:
+    // where a macro move leaves the box it pushed and the player, and how many pushes it took
+    struct End {
+        int box, player, pushes;
+    };
+
+    /// @brief Applies the macro move starting with push to boxes, appending its pushes to pushes if given.
+    End apply(Bitboard &boxes, const Push &push, std::vector<Push> *pushes) const;
+
+    /// @brief The fewest pushes taking a box from the entrance onto target, the player starting behind it and
+    ///        both kept inside the room, with the filled targets as walls. Empty if it cannot be done.
+    std::vector<Push> roomPushes(int target, const Bitboard &filled) const;
+
+    const Level &level;
+    bool enabled;
+    Direction inward {Direction::Up};
+
+    // goal room targets in fill order, the targets filled before each step and the pushes of each step
+    std::vector<int> order;
+    std::vector<Bitboard> filledBefore;
+    std::vector<std::vector<Push>> fillPushes;
+};
+
+#endif //SOKOBAN_MACROS_H
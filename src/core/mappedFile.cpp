@@ -0,0 +1,54 @@
+#include "mappedFile.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::close() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapping)
+        munmap(mapping, length);
+#endif
+    mapping = nullptr;
+    copy.clear();
+    bytes = nullptr;
+    length = 0;
+}
+
+bool MappedFile::open(const std::string &path) {
+    close();
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            mapping = mapped;
+            bytes = (const char *)mapped;
+            length = (size_t)info.st_size;
+        }
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        return false;
+    length = (size_t)in.tellg();
+    copy.resize((length + 7) / 8);
+    in.seekg(0);
+    in.read((char *)copy.data(), (std::streamsize)length);
+    bytes = length > 0 ? (const char *)copy.data() : nullptr;
+#endif
+    return bytes != nullptr;
+}
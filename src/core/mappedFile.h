@@ -0,0 +1,41 @@
+#ifndef SOKOBAN_MAPPED_FILE_H
+#define SOKOBAN_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The MappedFile class.
+ * @details A read-only view of a whole file, memory mapped where the platform allows it (so opening costs the
+ *          same whatever the size of the file, and pages are only read when touched) and read into an 8-byte
+ *          aligned copy elsewhere. Used by the binary formats that are read in place.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /// @brief Maps a file, replacing the one currently open.
+    /// @return false (and no data) if the file is missing or empty
+    bool open(const std::string &path);
+
+    void close();
+
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char *bytes {nullptr};
+    size_t length {0};
+
+    // the file mapping, or a copy of the file where memory mapping is not available
+    void *mapping {nullptr};
+    std::vector<uint64_t> copy;
+};
+
+#endif //SOKOBAN_MAPPED_FILE_H
@@ -0,0 +1,42 @@
+#include "moveJournal.h"
+
+void MoveJournal::record(Direction dir, bool pushed) {
+    const size_t i = cursor;
+    if (dirs.size() <= (i >> 5))
+        dirs.push_back(0);
+    if (pushes.size() <= (i >> 6))
+        pushes.push_back(0);
+
+    // overwrite whatever was there, the slot may hold a move that was undone
+    const int dirShift = (int)(i & 31) * 2;
+    uint64_t &dirWord = dirs[i >> 5];
+    dirWord = (dirWord & ~(uint64_t(3) << dirShift)) | (uint64_t(dir) << dirShift);
+
+    const uint64_t pushBit = uint64_t(1) << (i & 63);
+    uint64_t &pushWord = pushes[i >> 6];
+    pushWord = pushed ? (pushWord | pushBit) : (pushWord & ~pushBit);
+
+    ++cursor;
+    length = cursor;
+}
+
+JournalEntry MoveJournal::undo() {
+    return at(--cursor);
+}
+
+JournalEntry MoveJournal::redo() {
+    return at(cursor++);
+}
+
+void MoveJournal::clear() {
+    dirs.clear();
+    pushes.clear();
+    cursor = 0;
+    length = 0;
+}
+
+JournalEntry MoveJournal::at(size_t i) const {
+    const auto dir = static_cast<Direction>((dirs[i >> 5] >> ((i & 31) * 2)) & 3);
+    const bool pushed = (pushes[i >> 6] >> (i & 63)) & 1;
+    return {dir, pushed};
+}
@@ -0,0 +1,55 @@
+#ifndef SOKOBAN_MOVEJOURNAL_H
+#define SOKOBAN_MOVEJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "level.h"
+
+/// @brief One recorded move.
+struct JournalEntry {
+    Direction dir;
+    bool pushed;
+};
+
+/**
+ * @brief The MoveJournal class.
+ * @details Records the moves made in a level so they can be undone and redone. Each move costs 3 bits: the
+ *          direction is packed 2 bits at a time into one array (32 moves per word) and the push flag 1 bit at a
+ *          time into another (64 moves per word). Undo and redo only move a cursor.
+ * @see Game::undo(), Game::redo()
+ */
+class MoveJournal {
+public:
+    /// @brief Appends a move at the cursor, dropping any moves that could have been redone.
+    void record(Direction dir, bool pushed);
+
+    /// @brief Steps the cursor back and returns the move to revert. Only valid if canUndo().
+    JournalEntry undo();
+
+    /// @brief Steps the cursor forward and returns the move to replay. Only valid if canRedo().
+    JournalEntry redo();
+
+    /// @brief Forgets every move.
+    void clear();
+
+    bool canUndo() const { return cursor > 0; }
+    bool canRedo() const { return cursor < length; }
+
+    /// @brief Number of moves currently applied (undone moves are not counted).
+    size_t size() const { return cursor; }
+
+    /// @brief Returns the i-th applied move, i < size().
+    JournalEntry at(size_t i) const;
+
+private:
+    std::vector<uint64_t> dirs;
+    std::vector<uint64_t> pushes;
+
+    /// @brief Moves [0, cursor) are applied, moves [cursor, length) can be redone.
+    size_t cursor {0};
+    size_t length {0};
+};
+
+#endif //SOKOBAN_MOVEJOURNAL_H
@@ -0,0 +1,73 @@
+#include "nodeStore.h"
+#include "zobrist.h"
+
+#include <algorithm>
+
+SearchNode rootNode(const Level &level) {
+    SearchNode root {};
+    root.boxes = level.boxes;
+    root.player = (uint16_t)normalizedPlayer(level, level.boxes, level.playerStart);
+    root.boxHash = zobristBoxes(root.boxes);
+    root.hash = root.boxHash ^ ZOBRIST.player[root.player];
+    return root;
+}
+
+SearchNode childNode(const Level &level, const SearchNode &parent, uint32_t parentIndex, const Push &push) {
+    const int to = push.box + level.offset(push.dir);
+    SearchNode child {};
+    child.boxes = parent.boxes;
+    child.boxes.move(push.box, to);
+    // after the push the player stands where the box was
+    child.player = (uint16_t)normalizedPlayer(level, child.boxes, push.box);
+    child.boxHash = parent.boxHash ^ ZOBRIST.box[push.box] ^ ZOBRIST.box[to];
+    child.hash = child.boxHash ^ ZOBRIST.player[child.player];
+    child.parent = parentIndex;
+    child.pushBox = (uint16_t)push.box;
+    child.pushDir = push.dir;
+    child.depth = (uint16_t)(parent.depth + 1);
+    return child;
+}
+
+NodeStore::NodeStore() : visited(1024, Slot{EMPTY, 0}) {}
+
+std::pair<uint32_t, bool> NodeStore::insert(const SearchNode &node) {
+    if (2 * (nodes.size() + 1) > visited.size())
+        grow();
+    const size_t mask = visited.size() - 1;
+    const auto tag = (uint32_t)(node.hash >> 32);
+    for (size_t i = (size_t)node.hash & mask;; i = (i + 1) & mask) {
+        Slot &slot = visited[i];
+        if (slot.index == EMPTY) {
+            slot = {(uint32_t)nodes.size(), tag};
+            nodes.push_back(node);
+            return {slot.index, true};
+        }
+        if (slot.tag != tag)
+            continue;
+        const SearchNode &other = nodes[slot.index];
+        if (other.hash == node.hash && other.player == node.player && other.boxes == node.boxes)
+            return {slot.index, false};
+    }
+}
+
+void NodeStore::grow() {
+    std::vector<Slot> table(visited.size() * 2, Slot{EMPTY, 0});
+    const size_t mask = table.size() - 1;
+    for (uint32_t index {0}; index < (uint32_t)nodes.size(); ++index) {
+        const uint64_t hash = nodes[index].hash;
+        size_t i = (size_t)hash & mask;
+        while (table[i].index != EMPTY)
+            i = (i + 1) & mask;
+        table[i] = {index, (uint32_t)(hash >> 32)};
+    }
+    visited.swap(table);
+    nodes.reserve(visited.size() / 2);
+}
+
+std::vector<Push> NodeStore::pushesTo(uint32_t index) const {
+    std::vector<Push> pushes;
+    for (; index != 0; index = nodes[index].parent)
+        pushes.push_back({nodes[index].pushBox, nodes[index].pushDir});
+    std::reverse(pushes.begin(), pushes.end());
+    return pushes;
+}
@@ -0,0 +1,68 @@
+#ifndef SOKOBAN_NODESTORE_H
+#define SOKOBAN_NODESTORE_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "search.h"
+
+/// @brief A push state plus the push that led to it.
+struct SearchNode {
+    Bitboard boxes;
+    uint64_t boxHash;   // Zobrist hash of boxes alone, children update it with two xors
+    uint64_t hash;      // boxHash plus the normalized player
+    uint32_t parent;
+    uint16_t player;    // normalized
+    uint16_t pushBox;   // box cell before the push that created this node
+    Direction pushDir;
+    uint16_t depth;     // pushes from the start
+};
+
+/// @brief The start of the level as a search node (its own parent, depth 0).
+SearchNode rootNode(const Level &level);
+
+/// @brief The node reached by making push from parent.
+SearchNode childNode(const Level &level, const SearchNode &parent, uint32_t parentIndex, const Push &push);
+
+/**
+ * @brief The NodeStore class.
+ * @details Owns every node a single-threaded search has created and finds duplicates. Nodes are addressed by
+ *          their index, which stays valid as the store grows. The visited set is an open-addressed table of
+ *          8-byte slots, the node index plus the top half of its hash, so most probes that do not match are
+ *          turned down without reading the node itself.
+ */
+class NodeStore {
+public:
+    NodeStore();
+
+    NodeStore(const NodeStore &) = delete;
+    NodeStore &operator=(const NodeStore &) = delete;
+
+    /// @brief Adds a node unless an equal state is already stored.
+    /// @return the index of the node holding the state and true if it was added
+    std::pair<uint32_t, bool> insert(const SearchNode &node);
+
+    SearchNode &operator[](uint32_t index) { return nodes[index]; }
+    const SearchNode &operator[](uint32_t index) const { return nodes[index]; }
+    size_t size() const { return nodes.size(); }
+
+    /// @brief The pushes leading from the root (index 0) to a node.
+    std::vector<Push> pushesTo(uint32_t index) const;
+
+private:
+    struct Slot {
+        uint32_t index;     // EMPTY if the slot is free
+        uint32_t tag;       // hash >> 32 of the node
+    };
+
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    /// @brief Doubles the table and puts every node back, linear probing from the low bits of its hash.
+    void grow();
+
+    std::vector<SearchNode> nodes;
+    std::vector<Slot> visited;  // a power of two in size, at most half full
+};
+
+#endif //SOKOBAN_NODESTORE_H
@@ -0,0 +1,274 @@
+#include "solver.h"
+#include "deadlock.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+// Layer-synchronous parallel breadth-first search over pushes. Every thread owns a work deque (a mutex-guarded
+// std::deque, not a lock-free one) holding slices of the current layer; it takes slices from the back of its own
+// deque and steals from the front of the others when it runs dry. Children go to the owning thread's part of the
+// next layer, duplicates are filtered by a shared lock-free transposition table. Finishing a whole layer before
+// starting the next keeps the result push-optimal.
+
+namespace {
+    // items per work slice, small enough to balance, large enough to keep deque traffic low
+    const uint32_t SLICE = 32;
+
+    const uint64_t ROOT = ~uint64_t(0);
+
+    // rough memory of a state in a thread's set of states the table could not record
+    const size_t UNRECORDED_BYTES = 32;
+
+    struct FrontierItem {
+        Bitboard boxes;
+        uint64_t boxHash;
+        uint64_t id;        // (thread << 40) | index into that thread's parent log
+        uint16_t player;    // normalized
+        uint16_t depth;
+        uint16_t movedBox;  // cell of the box the last push moved, for the corral test
+    };
+
+    // how a state was reached, kept for every state so the solution can be rebuilt at the end
+    struct ParentRecord {
+        uint64_t parent;
+        uint16_t pushBox;
+        Direction pushDir;
+    };
+
+    struct Slice {
+        uint32_t owner;     // thread whose frontier the items are in
+        uint32_t begin, end;
+    };
+
+    class WorkDeque {
+    public:
+        void push(const Slice &slice) {
+            std::lock_guard<std::mutex> lock(mutex);
+            slices.push_back(slice);
+        }
+
+        bool pop(Slice &slice) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (slices.empty())
+                return false;
+            slice = slices.back();
+            slices.pop_back();
+            return true;
+        }
+
+        bool steal(Slice &slice) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (slices.empty())
+                return false;
+            slice = slices.front();
+            slices.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex mutex;
+        std::deque<Slice> slices;
+    };
+
+    class Barrier {
+    public:
+        explicit Barrier(int count) : count(count) {}
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            const uint64_t current = generation;
+            if (++waiting == count) {
+                waiting = 0;
+                ++generation;
+                released.notify_all();
+            } else {
+                released.wait(lock, [&] { return generation != current; });
+            }
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable released;
+        int count;
+        int waiting {0};
+        uint64_t generation {0};
+    };
+}
+
+SolverResult solveParallelBfs(const Level &level, const SolverOptions &options) {
+    SolverResult result;
+    // The memory cap covers everything this search holds: the table, the parent log (one record per state, kept
+    // to the end to rebuild the solution), the frontier items of the layer being expanded and the next one, and
+    // the states the table could not record.
+    // SearchBudget would count STATE_BYTES per state instead, so it only gets the time and state limits.
+    SolverOptions limits = options;
+    limits.memoryLimitMb = 0;
+    SearchBudget budget(limits);
+    const size_t memoryLimit = options.memoryLimitMb * 1024 * 1024;
+
+    const int threads = options.threads > 0 ? options.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    const Bitboard &dead = level.dead;
+
+    if (level.boxes.andNot(level.targets).none()) {
+        result.solved = true;
+        return result;
+    }
+
+    std::vector<std::vector<ParentRecord>> parents(threads);
+    std::vector<std::vector<FrontierItem>> current(threads), next(threads);
+    std::vector<WorkDeque> deques(threads);
+    std::vector<uint64_t> expanded(threads, 0), generated(threads, 0);
+    TranspositionTable visited(options.tableMegabytes, options.replacement);
+    // States whose bucket was full, so the table did not record them. Every parent in a layer would search such
+    // a state again, and so would its own children when it lies on a cycle of them, which multiplies the copies
+    // from layer to layer; remembering them here lets each thread search one at most once.
+    std::vector<std::unordered_set<uint64_t>> unrecorded(threads);
+    std::atomic<size_t> unrecordedCount {0};
+    Barrier barrier(threads);
+    std::atomic<bool> stop {false};     // cuts the current layer short, set by any thread
+    bool finished = false;              // ends the search, only written by thread 0 between the barriers
+    std::atomic<uint64_t> goal {ROOT};
+    std::atomic<size_t> states {1};
+    // frontier items handed out for the current layer and the state count when it started, only used by thread 0
+    size_t layerItems = 1, layerStart = 1;
+    bool outOfMemory = false;
+    auto overMemory = [&]() {
+        if (memoryLimit == 0 || outOfMemory)
+            return outOfMemory;
+        const size_t total = states.load();
+        const size_t frontier = layerItems + (total - layerStart);
+        outOfMemory = visited.bytes() + total * sizeof(ParentRecord) + frontier * sizeof(FrontierItem) +
+                      unrecordedCount.load() * UNRECORDED_BYTES > memoryLimit;
+        return outOfMemory;
+    };
+
+    // the root lives in thread 0's log
+    FrontierItem root {};
+    root.boxes = level.boxes;
+    root.boxHash = zobristBoxes(root.boxes);
+    root.player = (uint16_t)normalizedPlayer(level, root.boxes, level.playerStart);
+    root.id = 0;
+    parents[0].push_back({ROOT, 0, Direction::Up});
+    visited.insert(root.boxHash ^ ZOBRIST.player[root.player], 0);
+    current[0].push_back(root);
+    deques[0].push({0, 0, 1});
+
+    auto expand = [&](int me, const FrontierItem &item) {
+        const Bitboard reach = reachable(level, item.boxes, item.player);
+        // as in solveBfs, the corral sub-search waits until the item is expanded, the last layer never is
+        if (item.depth > 0 && isCorralDeadlock(level, item.boxes, item.movedBox, reach))
+            return;
+        ++expanded[me];
+        forEachPush(level, item.boxes, reach, [&](const Push &push) {
+            const int to = push.box + level.offset(push.dir);
+            if (dead.test(to))
+                return;
+            FrontierItem child {};
+            child.boxes = item.boxes;
+            child.boxes.move(push.box, to);
+            child.boxHash = item.boxHash ^ ZOBRIST.box[push.box] ^ ZOBRIST.box[to];
+            child.player = (uint16_t)normalizedPlayer(level, child.boxes, push.box);
+            child.depth = (uint16_t)(item.depth + 1);
+            child.movedBox = (uint16_t)to;
+            const uint64_t hash = child.boxHash ^ ZOBRIST.player[child.player];
+            bool recorded = true;
+            if (!visited.insert(hash, child.depth, &recorded))
+                return;
+            if (!recorded) {
+                if (!unrecorded[me].insert(hash).second)
+                    return;
+                ++unrecordedCount;
+            }
+            ++generated[me];
+            ++states;
+            child.id = ((uint64_t)me << 40) | parents[me].size();
+            parents[me].push_back({item.id, (uint16_t)push.box, push.dir});
+            if (child.boxes.andNot(level.targets).none()) {
+                uint64_t none = ROOT;
+                goal.compare_exchange_strong(none, child.id);
+                stop = true;
+            } else if (isLocalDeadlock(level, child.boxes, to)) {
+                return;
+            }
+            next[me].push_back(child);
+        });
+    };
+
+    auto worker = [&](int me) {
+        while (true) {
+            barrier.wait(); // layer ready
+            if (finished)
+                break;
+            Slice slice {};
+            while (!stop) {
+                bool found = deques[me].pop(slice);
+                for (int k {1}; !found && k < threads; ++k)
+                    found = deques[(me + k) % threads].steal(slice);
+                if (!found)
+                    break;
+                for (uint32_t i = slice.begin; i < slice.end && !stop; ++i)
+                    expand(me, current[slice.owner][i]);
+                if (me == 0 && (budget.exceeded(states) || overMemory()))
+                    stop = true;
+            }
+            barrier.wait(); // layer done
+
+            if (me == 0) {
+                // drain leftovers if the layer was cut short, then hand out the next layer
+                Slice leftover {};
+                for (WorkDeque &deque : deques)
+                    while (deque.pop(leftover)) {}
+                bool empty = true;
+                layerItems = 0;
+                layerStart = states;
+                for (int t {0}; t < threads; ++t) {
+                    current[t].swap(next[t]);
+                    layerItems += current[t].size();
+                    next[t].clear();
+                    const uint32_t size = (uint32_t)current[t].size();
+                    for (uint32_t begin {0}; begin < size; begin += SLICE)
+                        deques[t].push({(uint32_t)t, begin, std::min<uint32_t>(begin + SLICE, size)});
+                    empty = empty && current[t].empty();
+                }
+                finished = stop || empty || budget.exceeded(states) || overMemory();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t {1}; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread &thread : pool)
+        thread.join();
+
+    for (int t {0}; t < threads; ++t) {
+        result.expanded += expanded[t];
+        result.generated += generated[t];
+    }
+    result.generated += 1; // the root
+
+    const uint64_t found = goal.load();
+    if (found != ROOT) {
+        result.solved = true;
+        for (uint64_t id = found; id != 0;) {
+            const ParentRecord &record = parents[id >> 40][id & ((uint64_t(1) << 40) - 1)];
+            result.pushes.push_back({record.pushBox, record.pushDir});
+            id = record.parent;
+        }
+        std::reverse(result.pushes.begin(), result.pushes.end());
+    } else if (visited.lossless() && !budget.exceeded(states) && !outOfMemory &&
+               !(options.timeLimit > 0 && budget.elapsed() > options.timeLimit)) {
+        // every state was recorded, so the whole space really was searched
+        result.unsolvable = true;
+    }
+    result.tableEntries = visited.size();
+    result.tableFailedInserts = visited.failedInserts();
+    return result;
+}
@@ -0,0 +1,194 @@
+#include "patternDatabase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using std::string, std::cout, std::endl;
+
+namespace {
+    const char PATTERN_MAGIC[4] = {'S', 'K', 'P', 'D'};
+    const uint32_t PATTERN_VERSION = 1;
+    const size_t PATTERN_HEADER_SIZE = 24;
+
+    // keys are 2 bits per cell in a u64
+    const int MAX_WINDOW = 5;
+
+    uint32_t readU32(const char *in) {
+        uint32_t value = 0;
+        for (int i {0}; i < 4; ++i)
+            value |= (uint32_t)(uint8_t)in[i] << (8 * i);
+        return value;
+    }
+
+    void writeU32(char *out, uint32_t value) {
+        for (int i {0}; i < 4; ++i)
+            out[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+
+    // spreads the bits of a window row into the low bit of 2-bit key fields
+    constexpr uint64_t spread(uint32_t bits) {
+        uint64_t spreadBits = 0;
+        for (int i {0}; i < MAX_WINDOW; ++i)
+            spreadBits |= uint64_t((bits >> i) & 1) << (2 * i);
+        return spreadBits;
+    }
+
+    uint32_t slotOf(uint64_t key, uint32_t mask) {
+        return (uint32_t)((key * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+    }
+}
+
+PatternDatabase::~PatternDatabase() {
+    close();
+}
+
+void PatternDatabase::close() {
+    file.close();
+    slots = nullptr;
+    slotMask = 0;
+    patterns = 0;
+    window = 0;
+}
+
+bool PatternDatabase::open(const string &path) {
+    close();
+    if (!file.open(path))
+        return false;
+    const char *data = file.data();
+    const size_t size = file.size();
+    if (!data || size < PATTERN_HEADER_SIZE || memcmp(data, PATTERN_MAGIC, 4) != 0 ||
+        readU32(data + 4) != PATTERN_VERSION) {
+        cout << path << " is not a pattern database" << endl;
+        close();
+        return false;
+    }
+    const uint32_t slotCount = readU32(data + 16);
+    if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || size < PATTERN_HEADER_SIZE + slotCount * 8ull) {
+        cout << path << " is truncated" << endl;
+        close();
+        return false;
+    }
+    // the slots are read in place, the file is little endian like every platform the game builds for
+    window = (int)readU32(data + 8);
+    patterns = readU32(data + 12);
+    slots = (const uint64_t *)(data + PATTERN_HEADER_SIZE);
+    slotMask = slotCount - 1;
+    return true;
+}
+
+bool PatternDatabase::contains(uint64_t key) const {
+    if (!slots || key == 0)
+        return false;
+    for (uint32_t slot = slotOf(key, slotMask);; slot = (slot + 1) & slotMask) {
+        if (slots[slot] == key)
+            return true;
+        if (slots[slot] == 0)
+            return false;
+    }
+}
+
+bool PatternDatabase::isDeadlock(const Level &level, const Bitboard &boxes, int box) const {
+    if (empty())
+        return false;
+    // Same keys as windowKey(), but every window around the box is cut out of the same few rows of bits instead
+    // of testing its cells one by one.
+    const int row = box / level.width, col = box % level.width;
+    const int firstRow = std::max(0, row - window + 1), lastRow = std::min(row + window - 1, level.height - 1);
+    const int firstCol = std::max(0, col - window + 1);
+    const int span = std::min(col + window - 1, level.width - 1) - firstCol + 1;
+    uint32_t walls[2 * MAX_WINDOW], boxRows[2 * MAX_WINDOW], targets[2 * MAX_WINDOW];
+    for (int r = firstRow; r <= lastRow; ++r) {
+        const int start = r * level.width + firstCol;
+        walls[r - firstRow] = (uint32_t)level.walls.bits(start, span);
+        boxRows[r - firstRow] = (uint32_t)boxes.bits(start, span);
+        targets[r - firstRow] = (uint32_t)level.targets.bits(start, span);
+    }
+
+    const uint32_t mask = (1u << window) - 1;
+    for (int top = firstRow; top <= std::min(row, level.height - window); ++top) {
+        for (int left = firstCol; left <= std::min(col, level.width - window); ++left) {
+            const int shift = left - firstCol;
+            uint64_t key = 0;
+            bool hasTarget = false;
+            int boxCount = 0;
+            for (int i {0}; i < window; ++i) {
+                const int r = top - firstRow + i;
+                hasTarget = hasTarget || ((targets[r] >> shift) & mask);
+                boxCount += popcount64((boxRows[r] >> shift) & mask);
+                key |= (spread((walls[r] >> shift) & mask) | spread((boxRows[r] >> shift) & mask) << 1)
+                       << (2 * window * i);
+            }
+            // a box stuck in a window on its own is on a dead square, which the callers have ruled out
+            if (!hasTarget && boxCount > 1 && contains(key))
+                return true;
+        }
+    }
+    return false;
+}
+
+uint64_t PatternDatabase::windowKey(const Level &level, const Bitboard &boxes, int top, int left, int size) {
+    uint64_t key = 0;
+    bool anyBox = false;
+    int shift = 0;
+    for (int row = top; row < top + size; ++row) {
+        for (int col = left; col < left + size; ++col, shift += 2) {
+            const int cell = row * level.width + col;
+            if (level.isTarget(cell))
+                return 0;
+            if (level.isWall(cell)) {
+                key |= uint64_t(1) << shift;
+            } else if (boxes.test(cell)) {
+                key |= uint64_t(2) << shift;
+                anyBox = true;
+            }
+        }
+    }
+    return anyBox ? key : 0;
+}
+
+bool PatternDatabase::write(const string &path, int size, const std::vector<uint64_t> &keys) {
+    if (size < 1 || size > MAX_WINDOW) {
+        cout << "pattern window must be 1 to " << MAX_WINDOW << " cells wide" << endl;
+        return false;
+    }
+    // at most half full, so misses stop after a probe or two
+    uint32_t slotCount = 16;
+    while (slotCount < keys.size() * 2)
+        slotCount *= 2;
+    std::vector<uint64_t> table(slotCount, 0);
+    size_t count = 0;
+    for (uint64_t key : keys) {
+        uint32_t slot = slotOf(key, slotCount - 1);
+        while (table[slot] != 0 && table[slot] != key)
+            slot = (slot + 1) & (slotCount - 1);
+        count += table[slot] == 0;
+        table[slot] = key;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        cout << "could not write " << path << endl;
+        return false;
+    }
+    char header[PATTERN_HEADER_SIZE] = {};
+    memcpy(header, PATTERN_MAGIC, 4);
+    writeU32(header + 4, PATTERN_VERSION);
+    writeU32(header + 8, (uint32_t)size);
+    writeU32(header + 12, (uint32_t)count);
+    writeU32(header + 16, slotCount);
+    out.write(header, PATTERN_HEADER_SIZE);
+    for (uint64_t key : table) {
+        char bytes[8];
+        writeU32(bytes, (uint32_t)key);
+        writeU32(bytes + 4, (uint32_t)(key >> 32));
+        out.write(bytes, 8);
+    }
+    return (bool)out;
+}
+
+PatternDatabase &deadlockPatterns() {
+    static PatternDatabase patterns;
+    return patterns;
+}
@@ -0,0 +1,68 @@
+#ifndef SOKOBAN_PATTERN_DATABASE_H
+#define SOKOBAN_PATTERN_DATABASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "level.h"
+#include "mappedFile.h"
+
+/**
+ * @brief The PatternDatabase class.
+ * @details A read-only set of deadlock patterns learned offline by sokoban-patterns. A pattern is the content of
+ *          a small square window of the board (walls, boxes and floor, see windowKey()) whose boxes can never all
+ *          be pushed out of it, even if everything around the window were open floor. Patterns only apply to
+ *          windows without targets, where every box has to leave.
+ *
+ *          The file is the hash table itself, so open() maps it into memory instead of reading it and its cost
+ *          does not grow with the database. Layout, little endian:
+ *          "SKPD", u32 version (1), u32 window size, u32 pattern count, u32 slot count (a power of two),
+ *          u32 reserved, then one u64 key per slot, 0 for an empty slot (linear probing).
+ */
+class PatternDatabase {
+public:
+    PatternDatabase() = default;
+    ~PatternDatabase();
+
+    PatternDatabase(const PatternDatabase &) = delete;
+    PatternDatabase &operator=(const PatternDatabase &) = delete;
+
+    /// @brief Maps a database file, replacing the one currently open.
+    /// @return false (and an empty database) if the file is missing or not a pattern database
+    bool open(const std::string &path);
+
+    void close();
+
+    bool empty() const { return patterns == 0; }
+    size_t size() const { return patterns; }
+    int windowSize() const { return window; }
+
+    bool contains(uint64_t key) const;
+
+    /// @brief True if any window around the box on cell box matches a pattern.
+    /// @details At most windowSize()^2 windows, one hash probe each.
+    bool isDeadlock(const Level &level, const Bitboard &boxes, int box) const;
+
+    /// @brief Packs the window of the given size whose top left cell is (top, left) in padded grid coordinates.
+    /// @details Two bits per cell in row-major order: 0 floor, 1 wall, 2 box.
+    /// @return 0 if the window holds a target or no box, a pattern could never apply to it
+    static uint64_t windowKey(const Level &level, const Bitboard &boxes, int top, int left, int size);
+
+    /// @brief Writes keys as a database file for windows of the given size.
+    static bool write(const std::string &path, int size, const std::vector<uint64_t> &keys);
+
+private:
+    const uint64_t *slots {nullptr};
+    uint32_t slotMask {0};
+    size_t patterns {0};
+    int window {0};
+    MappedFile file;
+};
+
+/// @brief The database used by isDeadlockAfterPush(), empty until a file is opened.
+/// @details Open it once at startup, before any search threads run.
+PatternDatabase &deadlockPatterns();
+
+#endif //SOKOBAN_PATTERN_DATABASE_H
@@ -0,0 +1,204 @@
+#include "replay.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+
+using std::string, std::cout, std::endl;
+
+namespace {
+    const char REPLAY_MAGIC[4] = {'S', 'K', 'R', 'P'};
+    const uint8_t REPLAY_VERSION = 1;
+    const size_t REPLAY_HEADER_SIZE = 16;
+
+    // indexed by Direction
+    const char LURD_MOVES[4] = {'u', 'd', 'l', 'r'};
+
+    void writeU32(char *out, uint32_t value) {
+        for (int i {0}; i < 4; ++i)
+            out[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+
+    uint32_t readU32(const char *in) {
+        uint32_t value = 0;
+        for (int i {0}; i < 4; ++i)
+            value |= (uint32_t)(uint8_t)in[i] << (8 * i);
+        return value;
+    }
+
+    bool parseReplayText(const string &text, Replay &replay) {
+        std::istringstream in(text);
+        string line;
+        bool haveLevel = false;
+        replay = Replay();
+        while (getline(in, line)) {
+            if (line.empty() || line[0] == ';')
+                continue;
+            if (line.compare(0, 5, "level") == 0) {
+                replay.level = (int)strtol(line.c_str() + 5, nullptr, 10);
+                haveLevel = true;
+                continue;
+            }
+            for (char c : line) {
+                Direction dir;
+                bool pushed;
+                if (fromLurd(c, dir, pushed)) {
+                    replay.moves.push_back(c);
+                } else if (!isspace(static_cast<unsigned char>(c))) {
+                    cout << "invalid move '" << c << "' in replay" << endl;
+                    return false;
+                }
+            }
+        }
+        if (!haveLevel) {
+            cout << "replay has no level line" << endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool parseReplayBinary(const string &data, Replay &replay) {
+        if (data.size() < REPLAY_HEADER_SIZE || (uint8_t)data[4] != REPLAY_VERSION) {
+            cout << "unsupported replay version" << endl;
+            return false;
+        }
+        replay = Replay();
+        replay.level = (int)readU32(data.data() + 8);
+        const uint32_t count = readU32(data.data() + 12);
+        if (data.size() < REPLAY_HEADER_SIZE + (count + 3) / 4) {
+            cout << "truncated replay" << endl;
+            return false;
+        }
+        replay.hasPushFlags = false;
+        replay.moves.resize(count);
+        const char *packed = data.data() + REPLAY_HEADER_SIZE;
+        for (uint32_t i {0}; i < count; ++i)
+            replay.moves[i] = LURD_MOVES[((uint8_t)packed[i >> 2] >> ((i & 3) * 2)) & 3];
+        return true;
+    }
+}
+
+char toLurd(Direction dir, bool pushed) {
+    const char c = LURD_MOVES[static_cast<uint8_t>(dir)];
+    return pushed ? (char)toupper(c) : c;
+}
+
+bool fromLurd(char c, Direction &dir, bool &pushed) {
+    switch (c) {
+        case 'u': dir = Direction::Up;    pushed = false; return true;
+        case 'd': dir = Direction::Down;  pushed = false; return true;
+        case 'l': dir = Direction::Left;  pushed = false; return true;
+        case 'r': dir = Direction::Right; pushed = false; return true;
+        case 'U': dir = Direction::Up;    pushed = true;  return true;
+        case 'D': dir = Direction::Down;  pushed = true;  return true;
+        case 'L': dir = Direction::Left;  pushed = true;  return true;
+        case 'R': dir = Direction::Right; pushed = true;  return true;
+        default: return false;
+    }
+}
+
+string toLurd(const MoveJournal &journal) {
+    string moves(journal.size(), ' ');
+    for (size_t i {0}; i < journal.size(); ++i) {
+        const JournalEntry entry = journal.at(i);
+        moves[i] = toLurd(entry.dir, entry.pushed);
+    }
+    return moves;
+}
+
+ReplayResult runReplay(const Level &level, const Replay &replay, bool detectCycles) {
+    ReplayResult result;
+    Game game(level);
+    std::unordered_set<uint64_t> seen;
+    if (detectCycles)
+        seen.insert(game.getHash());
+
+    for (size_t i {0}; i < replay.moves.size(); ++i) {
+        Direction dir;
+        bool pushed;
+        // a Replay need not come from the parser, so a move may not be a move at all
+        if (!fromLurd(replay.moves[i], dir, pushed)) {
+            result.valid = false;
+            result.failedAt = i;
+            break;
+        }
+        const StepResult step = game.step(dir);
+        if (step == StepResult::Blocked
+            || (replay.hasPushFlags && pushed != (step == StepResult::Pushed))) {
+            result.valid = false;
+            result.failedAt = i;
+            break;
+        }
+        if (detectCycles && !seen.insert(game.getHash()).second) {
+            if (result.revisits++ == 0)
+                result.firstRevisit = i;
+        }
+    }
+    result.solved = game.isSolved();
+    result.moves = game.getMoves();
+    result.pushes = game.getPushes();
+    result.player = game.getPlayer();
+    result.boxes = game.getBoxes();
+    result.hash = game.getHash();
+    return result;
+}
+
+bool saveReplayText(const string &path, const Replay &replay) {
+    std::ofstream out(path);
+    if (!out) {
+        cout << "could not open " << path << endl;
+        return false;
+    }
+    out << "; sokoban replay\n";
+    out << "level " << replay.level << "\n";
+    // wrap long sessions so the file stays readable
+    for (size_t i {0}; i < replay.moves.size(); i += 80)
+        out << replay.moves.substr(i, 80) << "\n";
+    return (bool)out;
+}
+
+bool saveReplayBinary(const string &path, const Replay &replay) {
+    const size_t count = replay.moves.size();
+    string data(REPLAY_HEADER_SIZE + (count + 3) / 4, '\0');
+    memcpy(&data[0], REPLAY_MAGIC, 4);
+    data[4] = (char)REPLAY_VERSION;
+    writeU32(&data[8], (uint32_t)replay.level);
+    writeU32(&data[12], (uint32_t)count);
+    for (size_t i {0}; i < count; ++i) {
+        Direction dir;
+        bool pushed;
+        if (!fromLurd(replay.moves[i], dir, pushed)) {
+            cout << "invalid move '" << replay.moves[i] << "' in replay" << endl;
+            return false;
+        }
+        data[REPLAY_HEADER_SIZE + (i >> 2)] |= (char)(static_cast<uint8_t>(dir) << ((i & 3) * 2));
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        cout << "could not open " << path << endl;
+        return false;
+    }
+    out.write(data.data(), (std::streamsize)data.size());
+    return (bool)out;
+}
+
+bool loadReplay(const string &path, Replay &replay) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        cout << "could not open " << path << endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const string data = buffer.str();
+
+    if (data.size() >= 4 && memcmp(data.data(), REPLAY_MAGIC, 4) == 0)
+        return parseReplayBinary(data, replay);
+    return parseReplayText(data, replay);
+}
@@ -0,0 +1,86 @@
+#ifndef SOKOBAN_REPLAY_H
+#define SOKOBAN_REPLAY_H
+
+#include <cstddef>
+#include <string>
+
+#include "game.h"
+#include "moveJournal.h"
+
+/**
+ * @brief A recorded level session.
+ * @details Moves use the usual LURD notation: l, u, r, d for walking and L, U, R, D for pushes. Up is the same
+ *          direction as Direction::Up, i.e. up on the screen.
+ *
+ *          Text files (.lurd) look like
+ *              ; comments start with ';'
+ *              level 3
+ *              luRRdd...
+ *          where the moves may be split over any number of lines.
+ *
+ *          Binary files (.skr) are a 16 byte header followed by the moves packed 4 per byte (2 bits each, first
+ *          move in the lowest bits). Pushes are not stored, they follow from the rules when playing back.
+ *              bytes 0-3   "SKRP"
+ *              byte  4     format version (1)
+ *              bytes 5-7   reserved (0)
+ *              bytes 8-11  level id, little endian
+ *              bytes 12-15 number of moves, little endian
+ */
+struct Replay {
+    int level {0};
+    std::string moves;
+
+    /// @brief False for replays loaded from the binary format, whose moves are all lowercase.
+    bool hasPushFlags {true};
+};
+
+/// @brief Outcome of playing a replay back.
+struct ReplayResult {
+    /// @brief False if a move was blocked or its case did not match what happened (walk vs push).
+    bool valid {true};
+
+    /// @brief Index of the first rejected move, only meaningful if !valid.
+    size_t failedAt {0};
+
+    /// @brief True if every box was on a target after the last applied move.
+    bool solved {false};
+
+    int moves {0};
+    int pushes {0};
+
+    /// @brief Final position.
+    int player {0};
+    Bitboard boxes;
+    uint64_t hash {0};
+
+    /// @brief Moves that led back to a position seen earlier in the replay (only with detectCycles).
+    int revisits {0};
+
+    /// @brief Index of the first such move, only meaningful if revisits > 0.
+    size_t firstRevisit {0};
+};
+
+/// @brief Converts a move to its LURD character.
+char toLurd(Direction dir, bool pushed);
+
+/// @brief Converts a LURD character to a move.
+/// @return false if c is not one of lurdLURD
+bool fromLurd(char c, Direction &dir, bool &pushed);
+
+/// @brief Writes the applied moves of a journal in LURD notation.
+std::string toLurd(const MoveJournal &journal);
+
+/// @brief Plays a replay back from the start of the level, through the same rules as the game.
+/// @details Stops at the first move that is blocked, or whose case does not match when the replay has push flags.
+/// @param detectCycles Track the Zobrist hash of every position to count revisits (slower)
+ReplayResult runReplay(const Level &level, const Replay &replay, bool detectCycles = false);
+
+bool saveReplayText(const std::string &path, const Replay &replay);
+bool saveReplayBinary(const std::string &path, const Replay &replay);
+
+/// @brief Loads a replay in either format, the binary header is detected automatically.
+/// @details Binary replays come back with every move in lowercase and hasPushFlags cleared.
+/// @return false if the file could not be read or is malformed
+bool loadReplay(const std::string &path, Replay &replay);
+
+#endif //SOKOBAN_REPLAY_H
@@ -0,0 +1,119 @@
+#include "search.h"
+#include "replay.h"
+
+Bitboard reachable(const Level &level, const Bitboard &boxes, int player) {
+    const int width = level.width;
+    // shifts by a whole row only stay within neighbouring words up to 63 cells per row
+    if (width >= 64)
+        return reachableScalar(level, boxes, player);
+
+    uint64_t open[BOARD_WORDS], seen[BOARD_WORDS] {};
+    for (int i {0}; i < BOARD_WORDS; ++i)
+        open[i] = ~(level.walls.words[i] | boxes.words[i]);
+    seen[player >> 6] = uint64_t(1) << (player & 63);
+
+    // the wall ring around the level keeps every shift inside the grid and stops rows running into each other
+    while (true) {
+        // open + seen carries from each reached cell through the floor to its right in the row, flipping those bits
+        uint64_t carry = 0;
+        for (int i {0}; i < BOARD_WORDS; ++i) {
+            const uint64_t sum = open[i] + seen[i];
+            const uint64_t total = sum + carry;
+            carry = (sum < open[i]) | (total < sum);
+            seen[i] |= (total ^ open[i]) & open[i];
+        }
+
+        uint64_t grown[BOARD_WORDS];
+        for (int i {0}; i < BOARD_WORDS; ++i) {
+            const uint64_t below = i > 0 ? seen[i - 1] : 0, above = i + 1 < BOARD_WORDS ? seen[i + 1] : 0;
+            grown[i] = (seen[i] | seen[i] >> 1 | above << 63 |
+                        seen[i] << width | below >> (64 - width) |
+                        seen[i] >> width | above << (64 - width)) & open[i];
+        }
+        uint64_t changed = 0;
+        for (int i {0}; i < BOARD_WORDS; ++i) {
+            changed |= grown[i] ^ seen[i];
+            seen[i] = grown[i];
+        }
+        if (changed == 0)
+            break;
+    }
+    Bitboard region;
+    for (int i {0}; i < BOARD_WORDS; ++i)
+        region.words[i] = seen[i];
+    return region;
+}
+
+Bitboard reachable(const Level &level, const Bitboard &boxes, int player, int &normalized) {
+    const Bitboard region = reachable(level, boxes, player);
+    normalized = region.first();
+    return region;
+}
+
+Bitboard reachableScalar(const Level &level, const Bitboard &boxes, int player) {
+    const Bitboard blocked = level.walls | boxes;
+    Bitboard seen;
+    int queue[MAX_CELLS];
+    int head = 0, tail = 0;
+    seen.set(player);
+    queue[tail++] = player;
+    const int deltas[4] = {level.width, -level.width, -1, 1};
+    while (head < tail) {
+        const int cell = queue[head++];
+        for (int delta : deltas) {
+            const int next = cell + delta;
+            if (!blocked.test(next) && !seen.test(next)) {
+                seen.set(next);
+                queue[tail++] = next;
+            }
+        }
+    }
+    return seen;
+}
+
+bool walkPath(const Level &level, const Bitboard &boxes, int from, int to, std::string &moves) {
+    if (from == to)
+        return true;
+    const Bitboard blocked = level.walls | boxes;
+    // direction used to enter each cell, so the path can be walked back from the end
+    Direction cameFrom[MAX_CELLS];
+    Bitboard seen;
+    int queue[MAX_CELLS];
+    int head = 0, tail = 0;
+    seen.set(from);
+    queue[tail++] = from;
+    while (head < tail && !seen.test(to)) {
+        const int cell = queue[head++];
+        for (int d {0}; d < 4; ++d) {
+            const auto dir = static_cast<Direction>(d);
+            const int next = cell + level.offset(dir);
+            if (!blocked.test(next) && !seen.test(next)) {
+                seen.set(next);
+                cameFrom[next] = dir;
+                queue[tail++] = next;
+            }
+        }
+    }
+    if (!seen.test(to))
+        return false;
+
+    std::string path;
+    for (int cell = to; cell != from; cell -= level.offset(cameFrom[cell]))
+        path.push_back(toLurd(cameFrom[cell], false));
+    moves.append(path.rbegin(), path.rend());
+    return true;
+}
+
+std::string pushesToLurd(const Level &level, const std::vector<Push> &pushes) {
+    std::string moves;
+    Bitboard boxes = level.boxes;
+    int player = level.playerStart;
+    for (const Push &push : pushes) {
+        const int delta = level.offset(push.dir);
+        walkPath(level, boxes, player, push.box - delta, moves);
+        moves.push_back(toLurd(push.dir, true));
+        boxes.move(push.box, push.box + delta);
+        player = push.box;
+    }
+    return moves;
+}
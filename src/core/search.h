@@ -0,0 +1,63 @@
+#ifndef SOKOBAN_SEARCH_H
+#define SOKOBAN_SEARCH_H
+
+#include <string>
+#include <vector>
+
+#include "level.h"
+
+/**
+ * @brief Building blocks shared by the solvers.
+ * @details Solvers search over push states: the box set plus the region the player can walk to. Two positions
+ *          that only differ by where the player stands inside the same region are the same state, so the player
+ *          cell is normalized to the smallest cell index it can reach.
+ */
+
+/// @brief One push: the box on cell box is pushed one tile in dir.
+struct Push {
+    int box;
+    Direction dir;
+};
+
+/// @brief Cells the player can walk to from player without pushing anything.
+/// @details A bit-parallel flood fill: every round grows the whole region by one cell in each direction with shifts
+///          of the bitboard words, and runs of floor to the right are filled in one go by letting a carry ripple
+///          through them. Rounds stop when the region no longer grows, so a round costs a few dozen word
+///          operations however many cells it adds.
+Bitboard reachable(const Level &level, const Bitboard &boxes, int player);
+
+/// @brief reachable() that also gives the normalized player, the smallest cell index of the region.
+Bitboard reachable(const Level &level, const Bitboard &boxes, int player, int &normalized);
+
+/// @brief reachable() as a breadth-first search with a queue, one cell at a time. The reference the bit-parallel
+///        version is checked and timed against.
+Bitboard reachableScalar(const Level &level, const Bitboard &boxes, int player);
+
+/// @brief Smallest cell index the player can walk to.
+inline int normalizedPlayer(const Level &level, const Bitboard &boxes, int player) {
+    return reachable(level, boxes, player).first();
+}
+
+/// @brief Calls f(Push) for every push the player can make from the given reachable region.
+template <typename F>
+void forEachPush(const Level &level, const Bitboard &boxes, const Bitboard &reach, F f) {
+    const Bitboard blocked = level.walls | boxes;
+    boxes.forEach([&](int box) {
+        for (int d {0}; d < 4; ++d) {
+            const auto dir = static_cast<Direction>(d);
+            const int delta = level.offset(dir);
+            if (reach.test(box - delta) && !blocked.test(box + delta))
+                f(Push{box, dir});
+        }
+    });
+}
+
+/// @brief Shortest walk from one cell to another, avoiding walls and boxes, as lowercase LURD moves.
+/// @return false if to cannot be reached
+bool walkPath(const Level &level, const Bitboard &boxes, int from, int to, std::string &moves);
+
+/// @brief Turns a list of pushes made from the start of the level into a full LURD move string.
+/// @details Walks the player to each box with the shortest path and pushes it.
+std::string pushesToLurd(const Level &level, const std::vector<Push> &pushes);
+
+#endif //SOKOBAN_SEARCH_H
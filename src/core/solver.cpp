@@ -0,0 +1,49 @@
+#include "solver.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+SolverResult solve(const Level &level, const SolverOptions &options) {
+    SearchBudget timer(options);
+    const long peakBefore = peakMemoryKb();
+    SolverResult result;
+    switch (options.algorithm) {
+        case SolverAlgorithm::AStar:
+            result = solveAStar(level, options);
+            break;
+        case SolverAlgorithm::ParallelBfs:
+            result = solveParallelBfs(level, options);
+            break;
+        case SolverAlgorithm::Bidirectional:
+            result = solveBidirectional(level, options);
+            break;
+        case SolverAlgorithm::IdaStar:
+            result = solveIdaStar(level, options);
+            break;
+        case SolverAlgorithm::Bfs:
+        default:
+            result = solveBfs(level, options);
+            break;
+    }
+    if (result.solved && result.moves.empty())
+        result.moves = pushesToLurd(level, result.pushes);
+    result.milliseconds = timer.elapsed() * 1000.0;
+    result.peakMemoryKb = peakMemoryKb();
+    result.peakGrowthKb = result.peakMemoryKb - peakBefore;
+    return result;
+}
+
+long peakMemoryKb() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
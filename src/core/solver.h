@@ -0,0 +1,155 @@
+#ifndef SOKOBAN_SOLVER_H
+#define SOKOBAN_SOLVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "level.h"
+#include "search.h"
+#include "transpositionTable.h"
+
+/// @brief Search algorithms available to solve().
+enum class SolverAlgorithm {
+    Bfs,        // breadth-first over pushes, finds a push-optimal solution
+    AStar,      // best-first with the box/target matching lower bound, push-optimal when weight is 1
+    ParallelBfs,    // breadth-first split across threads with work stealing, push-optimal
+    Bidirectional,  // breadth-first from the start and (pulling) from the solved position, push-optimal
+    IdaStar     // iterative deepening A*, push-optimal, memory bound by the solution length
+};
+
+struct SolverOptions {
+    SolverAlgorithm algorithm {SolverAlgorithm::Bfs};
+
+    /// @brief Give up after this many seconds, 0 for no limit.
+    double timeLimit {0};
+
+    /// @brief Give up after storing this many states, 0 for no limit. IDA*, which stores none, gives up after
+    ///        generating this many.
+    size_t stateLimit {0};
+
+    /// @brief Give up once the stored states would take about this many megabytes, 0 for no limit. Counted per
+    ///        search (see STATE_BYTES), so searches running side by side each keep to their own cap. The parallel
+    ///        search counts what it actually holds instead: its table, parent log and frontier. IDA* only holds
+    ///        its path and table, so it keeps the table within the cap.
+    size_t memoryLimitMb {0};
+
+    /// @brief A* only: multiplies the heuristic. Above 1 finds solutions faster but they may use more pushes.
+    double weight {1.0};
+
+    /// @brief BFS, A* and IDA* only: make tunnel and goal room macro moves (see MacroMoves). Fewer nodes, but BFS then
+    ///        finds the fewest macro moves rather than the fewest pushes.
+    bool macros {false};
+
+    /// @brief Parallel search only: worker threads, 0 for one per hardware thread.
+    int threads {0};
+
+    /// @brief Parallel search and IDA*: memory for the transposition table and what it evicts when full. IDA*
+    ///        runs without a table when this is 0, the parallel search needs one.
+    size_t tableMegabytes {64};
+    ReplacementPolicy replacement {ReplacementPolicy::Shallower};
+
+    /// @brief Optional flag another thread sets to stop the search early, checked along with the limits.
+    const std::atomic<bool> *cancel {nullptr};
+};
+
+struct SolverResult {
+    bool solved {false};
+
+    /// @brief True if the whole search space was explored without finding a solution.
+    bool unsolvable {false};
+
+    /// @brief The solution as pushes and as LURD moves (uppercase = push).
+    std::vector<Push> pushes;
+    std::string moves;
+
+    /// @brief States taken off the frontier / states created.
+    uint64_t expanded {0};
+    uint64_t generated {0};
+
+    double milliseconds {0};
+
+    /// @brief Number of heuristic evaluations and the time spent in them (informed searches only).
+    uint64_t heuristicCalls {0};
+    double heuristicMilliseconds {0};
+
+    /// @brief Peak resident memory of the process when the search ended, which includes earlier searches, and how
+    ///        far this search raised it (0 if it stayed below an earlier peak).
+    long peakMemoryKb {0};
+    long peakGrowthKb {0};
+
+    /// @brief Searches with a transposition table: entries in use when the search ended, and inserts that evicted
+    ///        an entry or went unrecorded because the table was full (see TranspositionTable::failedInserts()).
+    uint64_t tableEntries {0};
+    uint64_t tableFailedInserts {0};
+
+    /// @brief IDA* only: nodes expanded by each pass, one entry per iteration.
+    std::vector<uint64_t> iterationNodes;
+
+    /// @brief Bidirectional search only: pushes from the start to where the two searches met, and from there on.
+    int forwardDepth {0};
+    int backwardDepth {0};
+};
+
+/// @brief Solves a level with the algorithm selected in options.
+SolverResult solve(const Level &level, const SolverOptions &options = SolverOptions());
+
+/// @brief Peak resident set size of this process in KB, 0 if unknown.
+long peakMemoryKb();
+
+/// @brief Rough memory of one stored state: the node plus the visited set and queue entries pointing at it.
+constexpr size_t STATE_BYTES = 128;
+
+/// @brief Wall clock and state budget of a search, checked by the solvers while they run.
+class SearchBudget {
+public:
+    explicit SearchBudget(const SolverOptions &options)
+        : timeLimit(options.timeLimit), stateLimit(options.stateLimit), cancel(options.cancel),
+          start(std::chrono::steady_clock::now()) {
+        // the memory cap is kept as a state limit, whichever of the two is lower
+        if (options.memoryLimitMb > 0) {
+            const size_t states = std::max<size_t>(options.memoryLimitMb * 1024 * 1024 / STATE_BYTES, 1);
+            stateLimit = stateLimit ? std::min(stateLimit, states) : states;
+        }
+    }
+
+    /// @brief The state limit in effect, 0 for none.
+    size_t states() const { return stateLimit; }
+
+    /// @brief True once the time or state limit is used up or the search was cancelled. Reading the clock is cheap
+    ///        but not free, so it is only looked at every 1024 calls.
+    bool exceeded(size_t states) {
+        if (stateLimit && states >= stateLimit)
+            return true;
+        if (cancel && cancel->load(std::memory_order_relaxed))
+            return true;
+        if (timeLimit <= 0 || (++calls & 1023) != 0)
+            return false;
+        return elapsed() > timeLimit;
+    }
+
+    /// @brief Seconds since the search started.
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    double timeLimit;
+    size_t stateLimit;
+    const std::atomic<bool> *cancel;
+    std::chrono::steady_clock::time_point start;
+    uint32_t calls {0};
+};
+
+// Algorithms, one translation unit each. Use solve() unless you need a specific one.
+SolverResult solveBfs(const Level &level, const SolverOptions &options);
+SolverResult solveAStar(const Level &level, const SolverOptions &options);
+SolverResult solveParallelBfs(const Level &level, const SolverOptions &options);
+SolverResult solveBidirectional(const Level &level, const SolverOptions &options);
+SolverResult solveIdaStar(const Level &level, const SolverOptions &options);
+
+#endif //SOKOBAN_SOLVER_H
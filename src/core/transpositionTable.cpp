@@ -0,0 +1,83 @@
+#include "transpositionTable.h"
+
+TranspositionTable::TranspositionTable(size_t megabytes, ReplacementPolicy policy) : policy(policy) {
+    const size_t budget = megabytes * 1024 * 1024 / (BUCKET_SIZE * sizeof(uint64_t));
+    bucketCount = 1;
+    while (bucketCount * 2 <= budget)
+        bucketCount *= 2;
+    entries.reset(new std::atomic<uint64_t>[capacity()]);
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i {0}; i < capacity(); ++i)
+        entries[i].store(0, std::memory_order_relaxed);
+    used = 0;
+    failed = 0;
+}
+
+bool TranspositionTable::contains(uint64_t hash) const {
+    const uint64_t tag = hash & ~DEPTH_MASK;
+    const std::atomic<uint64_t> *bucket = &entries[(hash & (bucketCount - 1)) * BUCKET_SIZE];
+    for (size_t i {0}; i < BUCKET_SIZE; ++i) {
+        const uint64_t entry = bucket[i].load(std::memory_order_acquire);
+        if (entry != 0 && (entry & ~DEPTH_MASK) == tag)
+            return true;
+    }
+    return false;
+}
+
+bool TranspositionTable::insert(uint64_t hash, uint16_t depth, bool *recorded) {
+    const uint64_t tag = hash & ~DEPTH_MASK;
+    // depth + 1 so that no entry is 0, saturating at the largest depth the entry holds
+    const uint64_t stored = depth < DEPTH_MASK ? depth + 1u : DEPTH_MASK;
+    const uint64_t value = tag | stored;
+    std::atomic<uint64_t> *bucket = &entries[(hash & (bucketCount - 1)) * BUCKET_SIZE];
+
+    // every failed compare-exchange means another thread changed the bucket, look at it again
+    while (true) {
+        int empty = -1, deepest = -1;
+        uint64_t deepestEntry = 0;
+        bool retry = false;
+        for (int i {0}; i < (int)BUCKET_SIZE && !retry; ++i) {
+            uint64_t entry = bucket[i].load(std::memory_order_acquire);
+            if (entry == 0) {
+                if (empty < 0)
+                    empty = i;
+                continue;
+            }
+            if ((entry & ~DEPTH_MASK) == tag) {
+                if ((entry & DEPTH_MASK) <= stored)
+                    return false;
+                if (bucket[i].compare_exchange_strong(entry, value, std::memory_order_acq_rel))
+                    return true;
+                retry = true;
+                continue;
+            }
+            if (deepest < 0 || (entry & DEPTH_MASK) > (deepestEntry & DEPTH_MASK)) {
+                deepest = i;
+                deepestEntry = entry;
+            }
+        }
+        if (retry)
+            continue;
+
+        if (empty >= 0) {
+            uint64_t expected = 0;
+            if (bucket[empty].compare_exchange_strong(expected, value, std::memory_order_acq_rel)) {
+                used.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            continue;
+        }
+
+        const bool evict = policy == ReplacementPolicy::Always ||
+                           (policy == ReplacementPolicy::Shallower && (deepestEntry & DEPTH_MASK) > stored);
+        if (evict && !bucket[deepest].compare_exchange_strong(deepestEntry, value, std::memory_order_acq_rel))
+            continue;
+        if (!evict && recorded)
+            *recorded = false;
+        failed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+}
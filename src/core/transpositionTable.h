@@ -0,0 +1,74 @@
+#ifndef SOKOBAN_TRANSPOSITION_TABLE_H
+#define SOKOBAN_TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// @brief What TranspositionTable::insert() does when the bucket of a new state is full.
+enum class ReplacementPolicy : uint8_t {
+    Shallower,  // evict the deepest entry if it is deeper than the new state (entries near the root prune more)
+    Always,     // always evict the deepest entry
+    Never       // keep the table as it is, the new state is not recorded
+};
+
+/**
+ * @brief The TranspositionTable class.
+ * @details A visited set of fixed size that any number of threads can use without locks. It is allocated once
+ *          and never grows, so its memory is known up front whatever the search does.
+ *
+ *          States are identified by their 64-bit Zobrist hash (boxes plus normalized player). An entry is a
+ *          single 64-bit word: the top 48 bits of the hash to verify the state, the low 16 bits the depth it was
+ *          seen at. Buckets of four entries (half a cache line) are picked by the low bits of the hash, so with
+ *          2^16 buckets or more all 64 bits of the hash are checked. Two states with the same hash are
+ *          taken for one another, which at 64 bits is rare enough for a search to accept.
+ *
+ *          Once an entry has been evicted, or a state was not recorded, a search may see that state again: it is
+ *          searched twice, never lost. lossless() tells whether that can have happened.
+ */
+class TranspositionTable {
+public:
+    /// @param megabytes Memory for the table, rounded down to a power of two number of buckets (at least one)
+    explicit TranspositionTable(size_t megabytes, ReplacementPolicy policy = ReplacementPolicy::Shallower);
+
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    /// @brief Records that a state was reached at depth.
+    /// @param recorded if given, set to false when the state is to be searched but its bucket was full and kept
+    ///        its entries, so the table will not know it next time
+    /// @return true if the state should be searched: it is new, or was only seen deeper before (the entry is
+    ///         lowered to depth). false if it was already seen at depth or less.
+    bool insert(uint64_t hash, uint16_t depth, bool *recorded = nullptr);
+
+    bool contains(uint64_t hash) const;
+
+    /// @brief Empties the table. Not safe while other threads use it.
+    void clear();
+
+    size_t capacity() const { return bucketCount * BUCKET_SIZE; }
+    size_t bytes() const { return capacity() * sizeof(uint64_t); }
+
+    /// @brief Entries in use.
+    size_t size() const { return used.load(std::memory_order_relaxed); }
+
+    /// @brief Inserts that evicted an entry for another state or did not record their state because its bucket
+    ///        was full. A state that fails again is counted again, so this is an upper bound on the states lost.
+    size_t failedInserts() const { return failed.load(std::memory_order_relaxed); }
+
+    /// @brief True if every state inserted is still in the table.
+    bool lossless() const { return failedInserts() == 0; }
+
+private:
+    static constexpr size_t BUCKET_SIZE = 4;
+    static constexpr uint64_t DEPTH_MASK = 0xffff;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> entries;   // 0 is an empty entry
+    size_t bucketCount;
+    ReplacementPolicy policy;
+    std::atomic<size_t> used {0};
+    std::atomic<size_t> failed {0};
+};
+
+#endif //SOKOBAN_TRANSPOSITION_TABLE_H
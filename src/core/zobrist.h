@@ -0,0 +1,46 @@
+#ifndef SOKOBAN_ZOBRIST_H
+#define SOKOBAN_ZOBRIST_H
+
+#include <cstdint>
+
+#include "bitboard.h"
+
+/**
+ * @brief Random keys for Zobrist hashing of positions.
+ * @details A position hashes to the xor of the key of every box cell and the key of the player cell, so a move
+ *          updates the hash with two xors and a push with four. The keys come from a fixed seed and are generated
+ *          at compile time, so hashes are the same across runs and machines.
+ */
+struct ZobristKeys {
+    uint64_t box[MAX_CELLS];
+    uint64_t player[MAX_CELLS];
+
+    constexpr ZobristKeys() : box(), player() {
+        // splitmix64
+        uint64_t state = 0x5eed5eed5eed5eedULL;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        };
+        for (int i {0}; i < MAX_CELLS; ++i) box[i] = next();
+        for (int i {0}; i < MAX_CELLS; ++i) player[i] = next();
+    }
+};
+
+inline constexpr ZobristKeys ZOBRIST {};
+
+/// @brief Hash of a box set alone.
+inline uint64_t zobristBoxes(const Bitboard &boxes) {
+    uint64_t hash = 0;
+    boxes.forEach([&hash](int cell) { hash ^= ZOBRIST.box[cell]; });
+    return hash;
+}
+
+/// @brief Hash of a full position, computed from scratch.
+inline uint64_t zobristHash(const Bitboard &boxes, int player) {
+    return zobristBoxes(boxes) ^ ZOBRIST.player[player];
+}
+
+#endif //SOKOBAN_ZOBRIST_H
@@ -1,4 +1,8 @@
 #include "engine.h"
+#include "../core/patternDatabase.h"
+#include "../core/replay.h"
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <random>
 
@@ -9,7 +13,7 @@ using std::to_string;
 
 // Colors
 color button, buttonComplete, buttonHover, completeHover, buttonClick, shadow,
-        wallColor, walkableColor, boxColor, boxOnTarget, targetColor, playerColor;
+        wallColor, walkableColor, boxColor, boxOnTarget, targetColor, playerColor, deadColor, hintColor;
 
 Engine::Engine() : keys() {
     this->initWindow();
@@ -21,6 +25,8 @@ Engine::Engine() : keys() {
     boxColor = {0.5, 0.25, 0, 1};    // brown
     targetColor = {1, 0.5, 0, 1};    // orange
     playerColor = {1, 0, 1, 1};      // purple
+    deadColor = {1, 0.75, 0.75, 1};  // pale red
+    hintColor = {0, 0.75, 0.75, 1};  // teal
     button = {1, 0, 0, 1};           // red
     buttonComplete = {0, 0.75, 0, 1};   // green for complete levels
     shadow = {0.5, 0.5, 0.5, 0};
@@ -28,9 +34,24 @@ Engine::Engine() : keys() {
     completeHover.vec = buttonComplete.vec + shadow.vec;
     buttonClick.vec = button.vec - shadow.vec; // dark version of button
     boxOnTarget.vec = (boxColor.vec + shadow.vec); // light brownish/orange
+
+    // deadlock patterns for the warning after each push, optional (mapped, not read, so this is instant)
+    deadlockPatterns().open("../res/deadlocks.skpd");
+    // the player is told about every deadlock, pattern and corral ones included
+    game.setDeadlockPatterns(&deadlockPatterns());
+    game.setCorralCheck(true);
+    hints.setTimeBudget(hintSeconds);
+    hints.setMemoryBudget(hintMegabytes);
+    openLevels();
+    orderLevels();
+    loadDifficulties();
+    currLevel = firstLevel();
+    loader.prefetch(currLevel); // for the start button
 }
 
-Engine::~Engine() {}
+Engine::~Engine() {
+    stopDifficulties();
+}
 
 unsigned int Engine::initWindow(bool debug) {
     // glfw: initialize and configure
@@ -117,8 +138,8 @@ void Engine::initShapes() {
                                              vec2{width/2 + 5,height/2 - 155},
                                              vec2{100, 50},
                                              color{0.5, 0, 0, 1});
-    // levelSelect screen
-    for(int i {0}; i < MAX_LEVEL; ++i) {
+    // levelSelect screen, one page of buttons whatever the size of the pack
+    for(int i {0}; i < LEVELS_PER_PAGE; ++i) {
         levelSelectButtons.push_back(make_unique<Rect>(shapeShader,
                                                        vec2{width/2 - ((i - 2) * 75),height/2},
                                                        vec2{50, 50},
@@ -265,12 +286,14 @@ void Engine::processInput() {
                 continueButton->setColor(buttonHover);
                 if(mousePressed) { continueButton->setColor(buttonClick); }
                 if(!mousePressed && mousePressedLastFrame) {
-                    currLevel = 1;
-                    initLevel(currLevel); // always start at level 1 when using the start button
-                    completedLevels[0] = false; // set to false in case player has already beat the level
-                    startTime = (float)glfwGetTime();
-                    moves = 0;
-                    screen = play;
+                    // always start at the first level of the pack when using the start button
+                    if(initLevel(firstLevel())) {
+                        currLevel = firstLevel();
+                        completedLevels.erase(currLevel); // in case player has already beat the level
+                        startTime = (float)glfwGetTime();
+                        moves = 0;
+                        screen = play;
+                    }
                 }
             } else {
                 continueButton->setColor(button);
@@ -280,32 +303,46 @@ void Engine::processInput() {
         case levelSelect: {
             // each button takes you to a corresponding level.
             // colored red if you have not beat the level,
-            // green if you have beat the level
-            for(int i {0}; i < MAX_LEVEL; ++i) {
+            // green if you have beat the level,
+            // grey and disabled if the tier filter hides it
+            for(int i {0}; i < LEVELS_PER_PAGE; ++i) {
+                // buttons are laid out right to left
+                const int level = pageLevel(LEVELS_PER_PAGE - 1 - i);
+                if(level < 0) {
+                    continue; // past the last level, the button is not drawn
+                }
+                const bool completed = completedLevels.count(level) > 0;
+                if(!levelShown(level)) {
+                    levelSelectButtons[i]->setColor(wallColor);
+                    levelSelectButtonsShadows[i]->setColor(wallColor.vec - shadow.vec);
+                    continue;
+                }
+                levelSelectButtonsShadows[i]->setColor(completed ? buttonComplete.vec - shadow.vec
+                                                                 : color{0.5, 0, 0, 1}.vec);
                 if(levelSelectButtons[i]->isOverlapping(vec2(MouseX, MouseY))) {
-                    if(completedLevels[i]) {
+                    if(completed) {
                         levelSelectButtons[i]->setColor(completeHover);
                     } else {
                         levelSelectButtons[i]->setColor(buttonHover);
                     }
-                    if(mousePressed && !completedLevels[i]) {
+                    if(mousePressed && !completed) {
                         levelSelectButtons[i]->setColor(buttonClick);
-                    } else if(mousePressed && completedLevels[i]) {
+                    } else if(mousePressed && completed) {
                         levelSelectButtons[i]->setColor(buttonComplete.vec - shadow.vec);
                     }
                     if(!mousePressed && mousePressedLastFrame) {
                         // if the player clicked a level button, initialize the level, update current level,
                         // start the timer, and switch to the play screen
-                        initLevel(5 - i);
-                        currLevel = 5 - i;
-                        startTime = (float)glfwGetTime();
-                        moves = 0;
-                        screen = play;
+                        if(initLevel(level)) {
+                            currLevel = level;
+                            startTime = (float)glfwGetTime();
+                            moves = 0;
+                            screen = play;
+                        }
                     }
                 } else {
-                    if(completedLevels[i]) {
+                    if(completed) {
                         levelSelectButtons[i]->setColor(buttonComplete);
-                        levelSelectButtonsShadows[i]->setColor(buttonComplete.vec - shadow.vec);
                     } else {
                         levelSelectButtons[i]->setColor(button);
                     }
@@ -353,7 +390,7 @@ void Engine::processInput() {
                 restartButton->setColor(buttonHover);
                 if(mousePressed) { restartButton->setColor(buttonClick); }
                 if(!mousePressed && mousePressedLastFrame) {
-                    initLevel(currLevel);
+                    restartLevel();
                     moves = 0;
                     startTime = (float)glfwGetTime();
                     screen = play;
@@ -369,10 +406,12 @@ void Engine::processInput() {
                 nextLevelButton->setColor(buttonHover);
                 if(mousePressed) { nextLevelButton->setColor(buttonClick); }
                 if(!mousePressed && mousePressedLastFrame) {
-                    initLevel(currLevel);
-                    startTime = (float)glfwGetTime();
-                    moves = 0;
-                    screen = play;
+                    // past the last level there is nothing to play, the screen stays as it is
+                    if(initLevel(currLevel)) {
+                        startTime = (float)glfwGetTime();
+                        moves = 0;
+                        screen = play;
+                    }
                 }
             } else {
                 nextLevelButton->setColor(button);
@@ -406,14 +445,37 @@ void Engine::processInput() {
 }
 
 void Engine::update() {
+    reloadLevels();
+    // pick up the difficulties once the worker is done with them
+    if(difficultiesDone) {
+        difficultyWorker.join();
+        difficultiesDone = false;
+        difficulties = std::move(estimatedDifficulties);
+        estimatedDifficulties.clear();
+        orderLevels();
+    }
+    // pick up a hint the worker finished, never waits for it
+    if(shownHint.status == HintStatus::Searching) {
+        Hint hint = hints.current();
+        if(hint.status != HintStatus::Searching) {
+            shownHint = hint;
+            if(hint.status == HintStatus::Found) {
+                refreshTileColor(hint.push.box);
+                refreshTileColor(hint.push.box + game.getLevel().offset(hint.push.dir));
+            }
+        }
+    }
     // End the game when all the boxes are in the correct position
     if(finishedLevel) {
+        saveReplay();
         endTime = (float)glfwGetTime();
         deltaTime = endTime - startTime;
-        completedLevels[5 - currLevel] = true;
-        ++currLevel;
+        completedLevels.insert(currLevel);
+        currLevel = nextLevel(currLevel);
         finishedLevel = false;
         screen = levelComplete;
+        // parse the next level while the player looks at the results
+        loader.prefetch(currLevel);
     }
 }
 
@@ -515,7 +577,10 @@ void Engine::render() {
             break;
         }
         case levelSelect: {
-            for(int i {0}; i < MAX_LEVEL; ++i) {
+            for(int i {0}; i < LEVELS_PER_PAGE; ++i) {
+                if(pageLevel(LEVELS_PER_PAGE - 1 - i) < 0) {
+                    continue;
+                }
                 // shadows
                 levelSelectButtonsShadows[i]->setUniforms();
                 levelSelectButtonsShadows[i]->draw();
@@ -530,10 +595,31 @@ void Engine::render() {
             levelMenuButton->setUniforms();
             levelMenuButton->draw();
 
-            for(int i {0}; i < MAX_LEVEL; ++i) {
-                fontRenderer->renderText(to_string(i + 1),
+            for(int i {0}; i < LEVELS_PER_PAGE; ++i) {
+                const int level = pageLevel(i);
+                if(level < 0) {
+                    break;
+                }
+                // ids of three digits and more at half size, so they stay on the button
+                fontRenderer->renderText(to_string(level),
                                          (float)width/2 + (float)((i - 2) * 100) + 85, (float)height/2 - 6,
-                                         1, vec3{1, 1, 1});
+                                         level < 100 ? 1 : 0.5, vec3{1, 1, 1});
+                // difficulty score under the button
+                fontRenderer->renderText(to_string((int)difficultyOf(level).score),
+                                         (float)width/2 + (float)((i - 2) * 100) + 85, (float)height/2 - 45,
+                                         0.5, vec3{1, 1, 1});
+            }
+            fontRenderer->renderText(sortByDifficulty ? "D order by number" : "D order by difficulty",
+                                     20, (float)height - 30,
+                                     0.5, vec3{1, 1, 1});
+            fontRenderer->renderText(string("F show: ") +
+                                     (tierFilter < 0 ? "all" : tierName(static_cast<DifficultyTier>(tierFilter))),
+                                     20, (float)height - 50,
+                                     0.5, vec3{1, 1, 1});
+            if(levelPages() > 1) {
+                fontRenderer->renderText("<- -> page " + to_string(levelPage + 1) + " of " + to_string(levelPages()),
+                                         20, (float)height - 70,
+                                         0.5, vec3{1, 1, 1});
             }
 
             fontRenderer->renderText("Choose a Level",
@@ -547,29 +633,51 @@ void Engine::render() {
             break;
         }
         case play: {
-            // Render tiles
-            int cols = (int)mapTiles.size();
-            int rows = (int)mapTiles[0].size();
-            for(int i {0}; i < cols; ++i) {
-                for(int j {0}; j < rows; ++j) {
-                    mapTiles[i][j]->setUniforms();
-                    mapTiles[i][j]->draw();
-                    // Check if a box is on top of a target
-                    if(solution[i][j] == 2 && mapState[i][j] == 2) {
-                        // Change box color
-                        mapTiles[i][j]->setColor(boxOnTarget);
-                    }
+            // Render tiles (none if no level could be loaded)
+            for(auto &row : mapTiles) {
+                for(auto &tile : row) {
+                    tile->setUniforms();
+                    tile->draw();
                 }
             }
             // Show pause button hotkey
             fontRenderer->renderText("ESC to pause",
                                      20, (float)height - 30,
                                      0.5, vec3{1, 1, 1});
+            fontRenderer->renderText("Z undo, Y redo",
+                                     20, (float)height - 50,
+                                     0.5, vec3{1, 1, 1});
+            fontRenderer->renderText("T show dead squares",
+                                     20, (float)height - 70,
+                                     0.5, vec3{1, 1, 1});
+            fontRenderer->renderText("H hint",
+                                     20, (float)height - 90,
+                                     0.5, vec3{1, 1, 1});
 
             // Render moves counter
             fontRenderer->renderText("Moves: " + std::to_string(moves),
                                      (float)width + 60, (float)height - 30,
                                      0.5, vec3{1, 1, 1});
+
+            // the last push lost the level, tell the player right away
+            if(game.isDeadlocked()) {
+                fontRenderer->renderText("Deadlock!",
+                                         (float)width + 60, (float)height - 60,
+                                         0.5, vec3{1, 0, 0});
+                fontRenderer->renderText("Z to undo",
+                                         (float)width + 60, (float)height - 80,
+                                         0.5, vec3{1, 0, 0});
+            }
+            else if(shownHint.status == HintStatus::Searching) {
+                fontRenderer->renderText("Thinking...",
+                                         (float)width + 60, (float)height - 60,
+                                         0.5, vec3{1, 1, 1});
+            }
+            else if(shownHint.status == HintStatus::NotFound) {
+                fontRenderer->renderText(shownHint.unsolvable ? "No solution" : "No hint found",
+                                         (float)width + 60, (float)height - 60,
+                                         0.5, vec3{1, 1, 1});
+            }
             break;
         }
         case pause: {
@@ -670,371 +778,327 @@ bool Engine::shouldClose() {
 
 // Helper function to set up a new level
 // Reads from ../res/maps.txt
-void Engine::initLevel(int level) {
-    // Reset the map
-    mapTiles.clear();
-    mapState.clear();
-    mapInit.clear();
-    solution.clear();
-
-    ifstream mapFile;
-    mapFile.open("../res/maps.txt");
-
-    string mapRow;
-    char firstChar;
-    // levels are prefixed with a digit
-    while(!isdigit(firstChar)) {
-        getline(mapFile, mapRow);
-        firstChar = mapRow.at(0);
-        // make sure we are at the desired level in the file
-        if(isdigit(firstChar)) {
-            // subtract 48 to adjust for ascii values not matching integers
-            if(firstChar - 48 != level) {
-                firstChar = '_';
-            }
+bool Engine::initLevel(int level) {
+    Level data;
+    if(!loader.get(level, data)) {
+        return false; // the board and the game stay as they are
+    }
+    hints.cancel();
+    shownHint = Hint();
+    game.load(data);
+    buildTiles();
+    return true;
+}
+
+void Engine::buildTiles() {
+    // Reset the map, keeping its tiles for the new one
+    for(auto &row : mapTiles) {
+        for(auto &tile : row) {
+            spareTiles.push_back(std::move(tile));
         }
     }
+    mapTiles.clear();
 
-    firstChar = '_';
-    // get the first line of the map
-    getline(mapFile, mapRow);
-    // initialize depth to be the length of the string
-    int size = mapRow.length();
-    mapTiles.resize(size);
-    solution.resize(size);
-
-    mapState.resize(size);
-    mapInit.resize(size);
-
-    int col {0}; // used for coordinates
-    int row {0}; // used for index and coordinates
-
-    while(!isdigit(firstChar) && !mapFile.eof()) {
-        for(char tile : mapRow) {
-            // if there are more rows than columns resize accordingly
-            // add 1 to adjust for 0 index
-            if (size > row) {
-                mapTiles.resize(row + 1);
-                solution.resize(row + 1);
-                mapInit.resize(row + 1);
-                mapState.resize(row + 1);
-            }
-            switch(tile) {
-                // floor
-                // add walkable to level and add 0 to solution, mapInit, mapState
-                // 0 - walkable tile
-                case '_': {
-                    mapTiles[row].push_back(make_unique<Rect>(shapeShader,
-                                                              vec2{(col * 50) + 25, (row * 50) + 25}, // grid of 50x50 tiles
-                                                              vec2{50, 50},
-                                                              color{1, 1, 1, 1}));
-                    solution[row].push_back(0);
-                    mapInit[row].push_back(0);
-                    mapState[row].push_back(0);
-                    ++col;
-                    break;
-                }
-                // wall
-                // add wall to level and add 1 to solution, mapInit, mapState
-                // 1 - wall tile
-                case 'X': {
-                    mapTiles[row].push_back(make_unique<Rect>(shapeShader,
-                                                              vec2{(col * 50) + 25, (row * 50) + 25}, // grid of 50x50 tiles
-                                                              vec2{50, 50},
-                                                              color{0.5, 0.5, 0.5, 1}));
-                    solution[row].push_back(1);
-                    mapInit[row].push_back(1);
-                    mapState[row].push_back(1);
-                    ++col;
-                    break;
-                }
-                // box
-                // add box to level, add 0 to solution and mapInit, add 2 to mapState
-                // 0 - walkable tile
-                // 2 - box
-                case '*': {
-                    mapTiles[row].push_back(make_unique<Rect>(shapeShader,
-                                                              vec2{(col * 50) + 25, (row * 50) + 25}, // grid of 50x50 tiles
-                                                              vec2{50, 50},
-                                                              color{0.5, 0.25, 0, 1}));
-                    solution[row].push_back(0);
-                    mapInit[row].push_back(0);
-                    mapState[row].push_back(2);
-                    ++col;
-                    break;
-                }
-                // target
-                // add target to level and add 2 to solution, 3 to mapInit
-                // 2 - box should be here
-                // 3 - target
-                case '!': {
-                    mapTiles[row].push_back(make_unique<Rect>(shapeShader,
-                                                              vec2{(col * 50) + 25, (row * 50) + 25}, // grid of 50x50 tiles
-                                                              vec2{50, 50},
-                                                              color{1, 0.5, 0, 1}));
-                    solution[row].push_back(2);
-                    mapInit[row].push_back(3);
-                    mapState[row].push_back(3);
-                    ++col;
-                    break;
-                }
-                // player
-                // add player to level and add 0 to solution, mapInit, mapState
-                // 0 - walkable tile
-                case '@': {
-                    mapTiles[row].push_back(make_unique<Rect>(shapeShader,
-                                                              vec2{(col * 50) + 25, (row * 50) + 25}, // grid of 50x50 tiles
-                                                              vec2{50, 50},
-                                                              color{1, 0, 1, 1}));
-                    solution[row].push_back(0);
-                    mapInit[row].push_back(0);
-                    mapState[row].push_back(0);
-                    playerPos.col = col;
-                    playerPos.row = row;
-                    ++col;
-                    break;
-                }
-                // box and target
-                // add box to level, 2 to solution and mapState, and 3 to mapInit
-                // 2 - box should be here
-                // 3 - target
-                case '$': {
-                    mapTiles[row].push_back(make_unique<Rect>(shapeShader,
-                                                              vec2{(col * 50) + 25, (row * 50) + 25}, // grid of 50x50 tiles
-                                                              vec2{50, 50},
-                                                              color{0.5, 0.25, 0, 1}));
-                    solution[row].push_back(2);
-                    mapInit[row].push_back(3);
-                    mapState[row].push_back(2);
-                    ++col;
-                    break;
-                }
-                default: {
-                    cout << "invalid character in level " << level << " map: " << mapRow << endl;
-                }
+    // one 50x50 tile per cell of the playable area
+    const Level &data = game.getLevel();
+    mapTiles.resize(data.rows);
+    for(int row {0}; row < data.rows; ++row) {
+        for(int col {0}; col < data.cols; ++col) {
+            const vec2 pos {(col * 50) + 25, (row * 50) + 25}; // grid of 50x50 tiles
+            if(spareTiles.empty()) {
+                mapTiles[row].push_back(make_unique<Rect>(shapeShader, pos, vec2{50, 50},
+                                                          tileColor(data.cell(row, col))));
+            } else {
+                spareTiles.back()->setPos(pos);
+                spareTiles.back()->setColor(tileColor(data.cell(row, col)));
+                mapTiles[row].push_back(std::move(spareTiles.back()));
+                spareTiles.pop_back();
             }
         }
-        // get the next line
-        getline(mapFile, mapRow);
-        ++row;
-        // reset x
-        col = 0;
-
-        // get first char to check if we've reached the next levels data
-        firstChar = mapRow.at(0);
     }
-    // shrink the map to prevent indexing errors elsewhere
-    mapTiles.resize(row);
-    mapFile.close();
 }
 
-void Engine::tryMovePlayer(const Engine::moveDir &dir) {
-    int row = playerPos.row;
-    int col = playerPos.col;
-    // Navigating the matrices:
-    // ex. mapState[row_idx][col_idx]
-    // Rows are in ascending order, bottom row is 0
-    //
-    // 0 - passable
-    // 1 - wall
-    // 2 - box
-    // 3 - target
-    // Is the above tile a wall? Do nothing if so
-    switch(dir) {
-        case moveDir::Up: {
-            if(mapState[row + 1][col] != 1) {
-                // There is a box, additional logic
-                if(mapState[row + 1][col] == 2) {
-                    // if there are at least 2 rows above the current row
-                    if(row + 2 < mapTiles.size()) {
-                        // if the 2nd tile is not a wall or box
-                        if(mapState[row + 2][col] != 1 && mapState[row + 2][col] != 2) {
-                            // the tile 2 above is now a box
-                            mapState[row + 2][col] = 2;
-                            mapTiles[row + 2][col]->setColor(boxColor);
-                            // update the mapState of the tile the box was in
-                            mapState[row + 1][col] = mapInit[row + 1][col];
-                            // set upper tile to be the player color
-                            mapTiles[row + 1][col]->setColor(playerColor);
-                            // set old player tile to be correct color
-                            setDefaultTileColor(row, col);
-                            // update player position
-                            ++playerPos.row;
-                            // increment moves counter
-                            ++moves;
-                            // check solution
-                            finishedLevel = checkSolution();
-                        }
-                    }
-                }
-                // No box, easy to move
-                else {
-                    // set upper tile to be the player color
-                    mapTiles[row + 1][col]->setColor(playerColor);
-                    // set old player tile to be correct color
-                    setDefaultTileColor(row, col);
-                    // update player position
-                    ++playerPos.row;
-                    // increment moves counter
-                    ++moves;
-                }
-            }
-            break;
-        }
-        case moveDir::Down: {
-            if(mapState[row - 1][col] != 1) {
-                // There is a box, additional logic
-                if(mapState[row - 1][col] == 2) {
-                    // if there are at least 2 rows below the current row
-                    if(row - 2 >= 0) {
-                        // if the 2nd tile is not a wall or box
-                        if(mapState[row - 2][col] != 1 && mapState[row - 2][col] != 2) {
-                            // the tile 2 below is now a box
-                            mapState[row - 2][col] = 2;
-                            mapTiles[row - 2][col]->setColor(boxColor);
-                            // update the mapState of the tile the box was in
-                            mapState[row - 1][col] = mapInit[row - 1][col];
-                            // set lower tile to be the player color
-                            mapTiles[row - 1][col]->setColor(playerColor);
-                            // set old player tile to be correct color
-                            setDefaultTileColor(row, col);
-                            // update player position
-                            --playerPos.row;
-                            // increment moves counter
-                            ++moves;
-                            // check solution
-                            finishedLevel = checkSolution();
-                        }
-                    }
-                }
-                // No box, easy to move
-                else {
-                    // set lower tile to be the player color
-                    mapTiles[row - 1][col]->setColor(playerColor);
-                    // set old player tile to be correct color
-                    setDefaultTileColor(row, col);
-                    // update player position
-                    --playerPos.row;
-                    // increment moves counter
-                    ++moves;
-                }
+void Engine::reloadLevels() {
+    if(!mapsWatcher.changed()) {
+        return;
+    }
+    const string mapsPath = "../res/maps.txt";
+    vector<int> changed;
+    bool reloaded {true};
+    stopDifficulties(); // it reads the pack being changed
+    loader.modify([&]() {
+        if(levels.format() == LevelFormat::Compiled) {
+            // maps.sklp is older than the edit now, levels come from the text from here on
+            for(int i {0}; i < levels.size(); ++i) {
+                changed.push_back(levels.id(i));
             }
-            break;
-        }
-        case moveDir::Right: {
-            if(mapState[row][col + 1] != 1) {
-                // There is a box, additional logic
-                if(mapState[row][col + 1] == 2) {
-                    // if there are at least 2 columns right of the current column
-                    if(col + 2 < mapState.size()) {
-                        // if the 2nd tile is not a wall or box
-                        if(mapState[row][col + 2] != 1 && mapState[row][col + 2] != 2) {
-                            // the tile 2 right is now a box
-                            mapState[row][col + 2] = 2;
-                            mapTiles[row][col + 2]->setColor(boxColor);
-                            // update the mapState of the tile the box was in
-                            mapState[row][col + 1] = mapInit[row][col + 1];
-                            // set right tile to be the player color
-                            mapTiles[row][col + 1]->setColor(playerColor);
-                            // set old player tile to be correct color
-                            setDefaultTileColor(row, col);
-                            // update player position
-                            ++playerPos.col;
-                            // increment moves counter
-                            ++moves;
-                            // check solution
-                            finishedLevel = checkSolution();
-                        }
-                    }
-                }
-                // No box, easy to move
-                else {
-                    // set right tile to be the player color
-                    mapTiles[row][col + 1]->setColor(playerColor);
-                    // set old player tile to be correct color
-                    setDefaultTileColor(row, col);
-                    // update player position
-                    ++playerPos.col;
-                    // increment moves counter
-                    ++moves;
-                }
+            reloaded = levels.open(mapsPath);
+            for(int i {0}; i < levels.size(); ++i) {
+                changed.push_back(levels.id(i));
             }
-            break;
+        } else {
+            reloaded = levels.reload(changed);
         }
-        case moveDir::Left: {
-            if(mapState[row][col - 1] != 1) {
-                // There is a box, additional logic
-                if(mapState[row][col - 1] == 2) {
-                    // if there are at least 2 columns left of the current column
-                    if(col - 2 >= 0) {
-                        // if the 2nd tile is not a wall or box
-                        if(mapState[row][col - 2] != 1 && mapState[row][col - 2] != 2) {
-                            // the tile 2 left is now a box
-                            mapState[row][col - 2] = 2;
-                            mapTiles[row][col - 2]->setColor(boxColor);
-                            // update the mapState of the tile the box was in
-                            mapState[row][col - 1] = mapInit[row][col - 1];
-                            // set left tile to be the player color
-                            mapTiles[row][col - 1]->setColor(playerColor);
-                            // set old player tile to be correct color
-                            setDefaultTileColor(row, col);
-                            // update player position
-                            --playerPos.col;
-                            // increment moves counter
-                            ++moves;
-                            // check solution
-                            finishedLevel = checkSolution();
-                        }
-                    }
-                }
-                // No box, easy to move
-                else {
-                    // set left tile to be the player color
-                    mapTiles[row][col - 1]->setColor(playerColor);
-                    // set old player tile to be correct color
-                    setDefaultTileColor(row, col);
-                    // update player position
-                    --playerPos.col;
-                    // increment moves counter
-                    ++moves;
-                }
-            }
-            break;
+        return changed;
+    });
+    if(reloaded) {
+        orderLevels(); // levels may have been added, removed or renumbered
+    }
+    loadDifficulties(); // the cache has the levels left as they were, only edited ones are estimated
+    if(!reloaded || std::find(changed.begin(), changed.end(), currLevel) == changed.end()) {
+        return;
+    }
+    if(screen != play && screen != pause) {
+        loader.prefetch(currLevel);
+        return;
+    }
+
+    // the level being played was edited: swap it in, the player stays where they stand if they still can
+    const Level &old = game.getLevel();
+    const int row = old.rowOf(game.getPlayer()), col = old.colOf(game.getPlayer());
+    Level data;
+    if(!loader.get(currLevel, data)) {
+        return; // saved half way through an edit, keep playing the old version until the next save
+    }
+    hints.cancel();
+    shownHint = Hint();
+    game.load(data);
+    if(row < data.rows && col < data.cols) {
+        game.placePlayer(data.cell(row, col));
+    }
+    moves = game.getMoves();
+    finishedLevel = false;
+    buildTiles();
+}
+
+void Engine::restartLevel() {
+    clearHint();
+    const Level &level = game.getLevel();
+    // cells whose box differs from the start, and where the player is now
+    const Bitboard moved = game.getBoxes() ^ level.boxes;
+    const int player = game.getPlayer();
+    game.reset();
+    moved.forEach([this](int cell) { refreshTileColor(cell); });
+    refreshTileColor(player);
+    refreshTileColor(level.playerStart);
+    finishedLevel = false;
+}
+
+void Engine::tryMovePlayer(const Direction &dir) {
+    // Navigating the board:
+    // Rows are in ascending order, bottom row is 0, so Up moves to row + 1
+    // The rules live in Game, here we only update the tiles that changed
+    int from = game.getPlayer();
+    StepResult result = game.step(dir);
+    if(result == StepResult::Blocked) {
+        return;
+    }
+    clearHint();
+    int to = game.getPlayer();
+    // set old player tile back to its floor/target color and the new tile to the player color
+    refreshTileColor(from);
+    refreshTileColor(to);
+    if(result == StepResult::Pushed) {
+        // the box moved one tile further in the same direction
+        refreshTileColor(to + game.getLevel().offset(dir));
+        // check solution
+        finishedLevel = game.isSolved();
+    }
+    // moves counter follows the game (undo decrements it)
+    moves = game.getMoves();
+}
+
+void Engine::undoMove() {
+    int from = game.getPlayer();
+    StepResult result = game.undo();
+    if(result == StepResult::Blocked) {
+        return;
+    }
+    clearHint();
+    int to = game.getPlayer();
+    refreshTileColor(from);
+    refreshTileColor(to);
+    if(result == StepResult::Pushed) {
+        // the box came back onto the tile the player left, the tile in front of it is now empty
+        refreshTileColor(2 * from - to);
+    }
+    moves = game.getMoves();
+}
+
+void Engine::redoMove() {
+    int from = game.getPlayer();
+    StepResult result = game.redo();
+    if(result == StepResult::Blocked) {
+        return;
+    }
+    clearHint();
+    int to = game.getPlayer();
+    refreshTileColor(from);
+    refreshTileColor(to);
+    if(result == StepResult::Pushed) {
+        refreshTileColor(2 * to - from);
+        finishedLevel = game.isSolved();
+    }
+    moves = game.getMoves();
+}
+
+void Engine::saveReplay() {
+    Replay replay;
+    replay.level = game.getLevel().id;
+    replay.moves = toLurd(game.getJournal());
+
+    std::error_code error;
+    std::filesystem::create_directories("../replays", error);
+    string path = "../replays/level" + to_string(replay.level);
+    saveReplayText(path + ".lurd", replay);
+    saveReplayBinary(path + ".skr", replay);
+}
+
+color Engine::tileColor(int cell) const {
+    const Level &level = game.getLevel();
+    if(cell == game.getPlayer()) {
+        return playerColor;
+    }
+    // the box to push next and the tile it goes to
+    if(shownHint.status == HintStatus::Found &&
+       (cell == shownHint.push.box || cell == shownHint.push.box + level.offset(shownHint.push.dir))) {
+        return hintColor;
+    }
+    if(game.hasBox(cell)) {
+        return level.isTarget(cell) ? boxOnTarget : boxColor;
+    }
+    if(level.isWall(cell)) {
+        return wallColor;
+    }
+    if(level.isTarget(cell)) {
+        return targetColor;
+    }
+    return showDeadSquares && level.isDead(cell) ? deadColor : walkableColor;
+}
+
+void Engine::refreshTileColor(int cell) {
+    const Level &level = game.getLevel();
+    mapTiles[level.rowOf(cell)][level.colOf(cell)]->setColor(tileColor(cell));
+}
+
+void Engine::requestHint() {
+    clearHint();
+    hints.request(game.getLevel(), game.getBoxes(), game.getPlayer());
+    shownHint.status = HintStatus::Searching; // update() polls until the worker answers
+}
+
+void Engine::clearHint() {
+    hints.cancel();
+    Hint old = shownHint;
+    shownHint = Hint();
+    if(old.status == HintStatus::Found) {
+        refreshTileColor(old.push.box);
+        refreshTileColor(old.push.box + game.getLevel().offset(old.push.dir));
+    }
+}
+
+void Engine::toggleDeadSquares() {
+    showDeadSquares = !showDeadSquares;
+    const Level &level = game.getLevel();
+    for(int row {0}; row < (int)mapTiles.size(); ++row) {
+        for(int col {0}; col < (int)mapTiles[row].size(); ++col) {
+            refreshTileColor(level.cell(row, col));
         }
     }
 }
 
-void Engine::setDefaultTileColor(int row, int col) {
-    int tile = mapInit[row][col];
-    switch (tile) {
-        case 0: {
-            mapTiles[row][col]->setColor(walkableColor);
-            break;
+void Engine::openLevels() {
+    const string mapsPath = "../res/maps.txt", compiledPath = "../res/maps.sklp";
+    // the compiled pack is only used if it was compiled from the maps as they are now: its header records their
+    // size, hash and time, so while the time matches this is a stat and the maps are not read
+    if(!std::filesystem::exists(mapsPath)) {
+        levels.open(compiledPath);
+        return;
+    }
+    CompiledPack compiled;
+    if(CompiledPack::isCompiled(compiledPath) && compiled.open(compiledPath) && compiled.compiledFrom(mapsPath)
+       && levels.open(compiledPath)) {
+        return;
+    }
+    levels.open(mapsPath);
+}
+
+void Engine::loadDifficulties() {
+    stopDifficulties();
+    difficultyWorker = std::thread([this]() {
+        const string cachePath = "../res/difficulty.cache";
+        vector<Level> shown;
+        for(int i {0}; i < levels.size() && !cancelDifficulties; ++i) {
+            Level level;
+            if(levels.load(i, level)) {
+                shown.push_back(level);
+            }
         }
-        case 1: {
-            mapTiles[row][col]->setColor(wallColor);
-            break;
+        DifficultyCache cache;
+        cache.load(cachePath);
+        const vector<Difficulty> found = estimateDifficulties(shown, cache, 2.0, 0, &cancelDifficulties);
+        if(cache.changed()) {
+            cache.save(cachePath); // what was estimated before a cancel is kept
         }
-        case 3: {
-            mapTiles[row][col]->setColor(targetColor);
-            break;
+        if(cancelDifficulties) {
+            return;
         }
-        default: {
-            cout << "invalid character in mapInit" << endl;
-            break;
+        for(size_t i {0}; i < shown.size(); ++i) {
+            estimatedDifficulties[shown[i].id] = found[i];
         }
+        difficultiesDone = true;
+    });
+}
+
+void Engine::stopDifficulties() {
+    if(!difficultyWorker.joinable()) {
+        return;
     }
+    cancelDifficulties = true;
+    difficultyWorker.join();
+    cancelDifficulties = false;
+    difficultiesDone = false;
+    estimatedDifficulties.clear();
 }
 
-bool Engine::checkSolution() {
-    for(int i {0}; i < mapState.size(); ++i) {
-        for(int j {0}; j < mapState[0].size(); ++j) {
-            if(mapState[i][j] != solution[i][j]) {
-                return false;
-            }
-        }
+void Engine::orderLevels() {
+    levelOrder.clear();
+    for(int i {0}; i < levels.size(); ++i) {
+        levelOrder.push_back(levels.id(i));
     }
-    return true;
+    if(sortByDifficulty) {
+        std::stable_sort(levelOrder.begin(), levelOrder.end(), [this](int a, int b) {
+            return difficultyOf(a).score < difficultyOf(b).score;
+        });
+    }
+    levelPage = std::min(levelPage, levelPages() - 1);
+}
+
+int Engine::pageLevel(int slot) const {
+    const size_t index = (size_t)levelPage * LEVELS_PER_PAGE + slot;
+    return index < levelOrder.size() ? levelOrder[index] : -1;
+}
+
+int Engine::levelPages() const {
+    return std::max(1, ((int)levelOrder.size() + LEVELS_PER_PAGE - 1) / LEVELS_PER_PAGE);
+}
+
+int Engine::firstLevel() const {
+    return levels.empty() ? -1 : levels.id(0);
+}
+
+int Engine::nextLevel(int level) const {
+    const int index = levels.find(level);
+    return index >= 0 && index + 1 < levels.size() ? levels.id(index + 1) : -1;
+}
+
+Difficulty Engine::difficultyOf(int level) const {
+    auto found = difficulties.find(level);
+    return found == difficulties.end() ? Difficulty() : found->second;
+}
+
+bool Engine::levelShown(int level) const {
+    return tierFilter < 0 || difficultyTier(difficultyOf(level)) == static_cast<DifficultyTier>(tierFilter);
 }
 
 void Engine::keyCallback(GLFWwindow* m_window, int key, int scancode, int action, int mods) {
@@ -1048,15 +1112,49 @@ void Engine::keyCallback(GLFWwindow* m_window, int key, int scancode, int action
     }
     // player movement in the play screen, WASD or arrow keys
     if ((keys[GLFW_KEY_UP] || keys[GLFW_KEY_W]) && screen == play) {
-        tryMovePlayer(moveDir::Up);
+        tryMovePlayer(Direction::Up);
     }
     else if ((keys[GLFW_KEY_DOWN] || keys[GLFW_KEY_S]) && screen == play) {
-        tryMovePlayer(moveDir::Down);
+        tryMovePlayer(Direction::Down);
     }
     else if ((keys[GLFW_KEY_RIGHT] || keys[GLFW_KEY_D]) && screen == play) {
-        tryMovePlayer(moveDir::Right);
+        tryMovePlayer(Direction::Right);
     }
     else if ((keys[GLFW_KEY_LEFT] || keys[GLFW_KEY_A]) && screen == play) {
-        tryMovePlayer(moveDir::Left);
+        tryMovePlayer(Direction::Left);
+    }
+    // undo/redo in the play screen, one move per press (holding the key repeats)
+    if ((action == GLFW_PRESS || action == GLFW_REPEAT) && screen == play) {
+        if (key == GLFW_KEY_Z) {
+            undoMove();
+        }
+        else if (key == GLFW_KEY_Y) {
+            redoMove();
+        }
+    }
+    // dead square tint, once per press
+    if (key == GLFW_KEY_T && action == GLFW_PRESS && screen == play) {
+        toggleDeadSquares();
+    }
+    // hint for the next push, searched in the background
+    if (key == GLFW_KEY_H && action == GLFW_PRESS && screen == play) {
+        requestHint();
+    }
+    // level select: order by difficulty, and cycle the tier filter all -> easy -> medium -> hard
+    if (key == GLFW_KEY_D && action == GLFW_PRESS && screen == levelSelect) {
+        sortByDifficulty = !sortByDifficulty;
+        orderLevels();
+    }
+    if (key == GLFW_KEY_F && action == GLFW_PRESS && screen == levelSelect) {
+        tierFilter = tierFilter >= (int)DifficultyTier::Hard ? -1 : tierFilter + 1;
+    }
+    // level select: turn the page, the pack may hold any number of levels
+    if ((action == GLFW_PRESS || action == GLFW_REPEAT) && screen == levelSelect) {
+        if (key == GLFW_KEY_LEFT) {
+            levelPage = std::max(levelPage - 1, 0);
+        }
+        else if (key == GLFW_KEY_RIGHT) {
+            levelPage = std::min(levelPage + 1, levelPages() - 1);
+        }
     }
 }
\ No newline at end of file
@@ -4,7 +4,11 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <atomic>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <GLFW/glfw3.h>
 
 #include "engineState.h"
@@ -13,6 +17,12 @@
 #include "../shapes/rect.h"
 #include "../shapes/shape.h"
 #include "debug.h"
+#include "../core/difficulty.h"
+#include "../core/game.h"
+#include "../core/hint.h"
+#include "../core/levelLoader.h"
+#include "../core/levelPack.h"
+#include "../core/levelWatcher.h"
 
 using std::tuple, std::get, std::unique_ptr, std::make_unique, glm::ortho, glm::mat4, glm::vec3, glm::vec4;
 /**
@@ -60,7 +70,7 @@ class Engine : public EngineState {
         unique_ptr<Shape> quitButtonShadow;                     // main menu
         unique_ptr<Shape> continueButton;                       // instructions
         unique_ptr<Shape> continueButtonShadow;                 // instructions
-        vector<unique_ptr<Shape>> levelSelectButtons;           // level select
+        vector<unique_ptr<Shape>> levelSelectButtons;           // level select, one page (right to left)
         vector<unique_ptr<Shape>> levelSelectButtonsShadows;    // level select
         unique_ptr<Shape> levelMenuButton;                      // level select
         unique_ptr<Shape> levelMenuButtonShadow;                // level select
@@ -83,59 +93,28 @@ class Engine : public EngineState {
         unique_ptr<Rect> box;                                   // instructions
         unique_ptr<Rect> target;                                // instructions
 
-        vector<vector<unique_ptr<Shape>>> mapTiles; // graphical representation of mapState
-        // 0 - passable
-        // 1 - wall
-        // 2 - box
-        // 3 - target
-        vector<vector<int>> mapInit;  // initial map state (used to change tiles back to their original color)
-        /* Maps are displayed in the horizontal inverse
-        *  i.e. the bottom line is actually the top when rendered
-        *
-        *  Example: Level 1 (playable area)
-        *
-        *  1 1 1 1 1 1 1 1
-        *  1 0 0 0 3 0 0 1
-        *  1 0 0 3 0 0 3 1
-        *  1 0 1 0 3 0 1 1
-        *  1 3 1 1 0 0 1 1
-        *  1 1 1 0 0 3 1 1
-        *  1 3 0 0 0 0 1 1
-        *  1 1 1 0 0 0 1 1
-        *  1 1 1 1 1 1 1 1
-        */
-        vector<vector<int>> mapState; // current map state
-        /* Maps are displayed in the horizontal inverse
-         *  i.e. the bottom line is actually the top when rendered
-         *
-         *  Example: Level 1 (playable area)
-         *
-         *  1 1 1 1 1 1 1 1
-         *  1 0 0 0 3 0 0 1
-         *  1 2 0 2 2 2 3 1
-         *  1 0 1 0 3 0 1 1
-         *  1 3 1 1 2 0 1 1
-         *  1 1 1 0 2 3 1 1
-         *  1 3 0 2 0 0 1 1
-         *  1 1 1 0 0 0 1 1
-         *  1 1 1 1 1 1 1 1
-         */
-        vector<vector<int>> solution; // map state should equal this
-        /* Maps are displayed in the horizontal inverse
-        *  i.e. the bottom line is actually the top when rendered
-        *
-        *  Example: Level 1 (playable area)
-        *
-        *  1 1 1 1 1 1 1 1
-        *  1 0 0 0 2 0 0 1
-        *  1 0 0 2 0 0 2 1
-        *  1 0 1 0 2 0 1 1
-        *  1 2 1 1 0 0 1 1
-        *  1 1 1 0 0 2 1 1
-        *  1 2 0 0 0 0 1 1
-        *  1 1 1 0 0 0 1 1
-        *  1 1 1 1 1 1 1 1
-        */
+        // graphical representation of the game board, indexed [row][col]
+        // tile colors are kept in sync with game after every move (see refreshTileColor())
+        vector<vector<unique_ptr<Shape>>> mapTiles;
+
+        // tiles left over from a bigger level, reused before new ones are created (see initLevel())
+        vector<unique_ptr<Shape>> spareTiles;
+
+        /// @brief Rules and state of the current level (player, boxes, targets).
+        /// @details Headless, the engine only reads from it to color mapTiles.
+        Game game;
+
+        /// @brief Finds hints on a worker thread, polled once per frame in update().
+        HintSolver hints;
+
+        /// @brief The hint highlighted on the board (status None when there is none).
+        Hint shownHint;
+
+        /// @brief Seconds the hint search may take before it reports that it found nothing.
+        float hintSeconds {2.0f};
+
+        /// @brief Megabytes of search states the hint search may hold before it reports that it found nothing.
+        size_t hintMegabytes {64};
 
         // Shaders
         Shader shapeShader;
@@ -146,7 +125,9 @@ class Engine : public EngineState {
         double MouseX, MouseY;
 
         // Game information
-        const int MAX_LEVEL = 5; // keeping this manually updated is fine (also update completedLevels[])
+        LevelPack levels; // see openLevels()
+        LevelLoader loader {levels}; // loads the next level on a worker while the player is on levelComplete
+        LevelWatcher mapsWatcher {"../res/maps.txt"}; // edits to the levels are picked up by reloadLevels()
 
         /* deltaTime variables */
         float startTime {0.0f}; // when play screen is entered
@@ -156,54 +137,135 @@ class Engine : public EngineState {
         // Player stats
         int moves {0};
         bool finishedLevel {false}; // is the current level won?
-        bool completedLevels [5] {false}; // levels beaten this session (for graphics)
+        bool showDeadSquares {false}; // tint floor a box can never leave (toggled with T, kept across levels)
+        std::unordered_set<int> completedLevels; // ids of the levels beaten this session (for graphics)
 
-        // players current level, increments on levelComplete. Changed when choosing a level via levelSelect.
-        int currLevel{1};
+        /// @brief Estimated difficulty of the levels of the pack, by level id (see loadDifficulties()).
+        std::unordered_map<int, Difficulty> difficulties;
+
+        /// @brief Worker reading and estimating the difficulties, its results handed over in estimatedDifficulties
+        ///        once difficultiesDone is set, stopped early by setting cancelDifficulties (see stopDifficulties()).
+        std::thread difficultyWorker;
+        std::unordered_map<int, Difficulty> estimatedDifficulties;
+        std::atomic<bool> difficultiesDone {false};
+        std::atomic<bool> cancelDifficulties {false};
 
-        // Where in the world is Carmen Sandiego? (player coordinates in the matrix)
-        struct position {
-            int col;
-            int row;
-        };
-        // actual position of the player in the game matrix
-        position playerPos;
-
-        // makes it easier to know which direction the player wants to move
-        // use enum class to avoid implicit type conversion
-        enum class moveDir {
-            Up,
-            Down,
-            Left,
-            Right
-        };
+        /// @brief Ids of every level of the pack in the order of the level select, left to right and page by page
+        ///        (see orderLevels()).
+        vector<int> levelOrder;
+
+        /// @brief Level select buttons per page, and the page shown (arrow keys turn it).
+        static constexpr int LEVELS_PER_PAGE = 5;
+        int levelPage {0};
+
+        // level select options: order by difficulty instead of number (D), show one tier only (F, -1 for all)
+        bool sortByDifficulty {false};
+        int tierFilter {-1};
+
+        // players current level id, moves to the next level of the pack on levelComplete (see nextLevel()).
+        // Changed when choosing a level via levelSelect.
+        int currLevel{1};
 
         /// @brief Helper function to set up a level
-        /// @inputs int level - the level number to set up
-        /// @details Levels start at 1 and go up to MAX_LEVEL. This function takes an input level number
-        ///          and sets up the graphics, mapInit, mapState, and solution matrices.
-        ///          Reads from a file ../res/maps.txt
-        void initLevel(int level);
+        /// @inputs int level - the id of the level to set up
+        /// @details Any id of the pack (see LevelEntry::id). This function takes an input level id,
+        ///          loads it into game and builds the tiles used to draw it.
+        ///          The level comes from loader, already parsed if it was prefetched. Tiles are reused from the last
+        ///          level (all tiles share the same unit quad, a tile is placed by its uniforms), so only a level
+        ///          bigger than any before it creates vertex buffers.
+        /// @return false if the level is missing or invalid, the current level and its tiles are then kept
+        bool initLevel(int level);
+
+        /// @brief Rebuilds mapTiles for the level in game, reusing the tiles of the last one
+        void buildTiles();
+
+        /// @brief Reloads ../res/maps.txt after it was saved, polled once per frame in update()
+        /// @details Only the levels around the edit are indexed and parsed again (see LevelPack::reload()). If the
+        ///          level being played was edited it is swapped in at once: boxes back to their start, the player
+        ///          left where they stand if that is still floor. Edited levels have their difficulty
+        ///          estimated again in the background.
+        void reloadLevels();
+
+        /// @brief Puts the current level back to its start without loading anything
+        /// @details game keeps the parsed level, so this copies its starting boxes and player back and recolors
+        ///          the tiles that differ from the start. No file access, no tiles created.
+        void restartLevel();
 
         /// @brief Attempts to move the player in a given direction
-        /// @inputs enum moveDir - desired direction
-        /// @details This function takes an input direction and tries to move the player. If there is a box,
-        ///          additional logic checks the next tile to see if the box can be pushed. If a box is
-        ///          successfully pushed, checkSolution() is invoked to see if the level is completed
-        /// @see Engine::checkSolution()
-        void tryMovePlayer(const moveDir &dir);
+        /// @inputs Direction dir - desired direction
+        /// @details Forwards the move to game and recolors the tiles that changed. If a box was
+        ///          pushed, finishedLevel is updated from Game::isSolved()
+        /// @see Game::step()
+        void tryMovePlayer(const Direction &dir);
+
+        /// @brief Reverts the last move and recolors the tiles that changed
+        /// @see Game::undo()
+        void undoMove();
+
+        /// @brief Replays the last undone move and recolors the tiles that changed
+        /// @see Game::redo()
+        void redoMove();
+
+        /// @brief Writes the moves of the current level to ../replays/level<N>.lurd and .skr
+        /// @details Called when a level is completed, play it back with sokoban-replay.
+        void saveReplay();
+
+        /// @brief Returns the color a tile should have given the current game state
+        /// @inputs int cell - the index of the tile in the game board
+        color tileColor(int cell) const;
 
         /// @brief Helper function to change tile color when moving
-        /// @inputs int row, int col - the index of the tile in the matrix whose color needs to be restored
-        /// @details This function takes an index and restores the tiles color to its original state of
-        ///          walkable or target when the player moves.
-        void setDefaultTileColor(int row, int col);
-
-        /// @brief Checks if the current map state is the same as the solution
-        /// @details This function should be triggered whenever the player pushes a box. It compares the mapState
-        ///          matrix to the solution matrix. If they are equal, proceed to levelComplete screen.
-        /// @return true if mapState = solution, false otherwise
-        bool checkSolution();
+        /// @inputs int cell - the index of the tile in the game board whose color needs to be updated
+        /// @details Sets the tile to the player, box, target, walkable or wall color.
+        void refreshTileColor(int cell);
+
+        /// @brief Asks hints for the next push from the current position (H in the play screen)
+        /// @details Returns immediately, the answer is picked up by update().
+        void requestHint();
+
+        /// @brief Cancels the pending hint and removes the highlight, called whenever the position changes
+        void clearHint();
+
+        /// @brief Opens ../res/maps.sklp (compiled by sokoban-levelc, loaded without parsing) if it was compiled
+        ///        from ../res/maps.txt as it is now, else indexes ../res/maps.txt once so each level load parses
+        ///        only that level
+        void openLevels();
+
+        /// @brief Reads the difficulty of every level from ../res/difficulty.cache on difficultyWorker
+        /// @details Levels missing from the cache (new or edited ones) are estimated there on all cores and the cache
+        ///          is written back, so this only takes time the first time a level is seen. The window opens at once:
+        ///          update() fills the scores in when the worker is done, until then they read 0.
+        void loadDifficulties();
+
+        /// @brief Cancels difficultyWorker and waits for it, dropping what it had not handed over
+        void stopDifficulties();
+
+        /// @brief Fills levelOrder with every level of the pack, in pack order or by difficulty if
+        ///        sortByDifficulty is set, and keeps levelPage within the pages there are
+        void orderLevels();
+
+        /// @brief Id of the level in a slot of the level select page shown (0 is the leftmost), -1 if the slot is
+        ///        past the last level
+        int pageLevel(int slot) const;
+
+        /// @brief Pages of the level select screen, at least one
+        int levelPages() const;
+
+        /// @brief Id of the first level of the pack, where the start button begins, -1 if the pack is empty
+        int firstLevel() const;
+
+        /// @brief Id of the level after this one in the pack (ids need not be consecutive), -1 after the last
+        int nextLevel(int level) const;
+
+        /// @brief Estimated difficulty of a level, a zero score if it has none yet
+        Difficulty difficultyOf(int level) const;
+
+        /// @brief Whether a level passes the tier filter of the level select screen
+        bool levelShown(int level) const;
+
+        /// @brief Turns the dead square tint on or off and recolors the board
+        /// @see Level::dead
+        void toggleDeadSquares();
 
         /// @brief Implements the functionality for glfw keyboard listener
         /// @details Registers keyboard inputs for player movement and tries to
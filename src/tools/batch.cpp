@@ -0,0 +1,251 @@
+// sokoban-batch: solves every level of one or more level packs on a thread pool and reports the results as CSV or
+// JSON, one record per level written as soon as that level is done.
+//
+// usage: sokoban-batch [--algorithm astar|bfs|bidir|ida] [--weight <w>] [--jobs <n>] [--time-limit <s>]
+//                      [--memory-mb <n>] [--format csv|json] [--out <file>] [--patterns <file>] <file|directory>...
+//   --algorithm   astar (default), bfs, bidir or ida, see sokoban-solve; ida keeps to little memory on small
+//                 hosts, with a transposition table of --memory-mb / 4
+//   --weight      A* heuristic weight
+//   --jobs        levels solved at once (default: one per hardware thread)
+//   --time-limit  seconds per level (default 60)
+//   --memory-mb   megabytes of search states per level (default 512), so the whole batch stays under
+//                 jobs * memory-mb
+//   --format      csv (default) or json
+//   --out         report file (default batch.csv or batch.json)
+//   --patterns    deadlock pattern database (default ../res/deadlocks.skpd, skipped if missing)
+//   <file>        a level file in the res/maps.txt format, or XSB if it ends in .xsb or .sok; a directory stands
+//                 for every .txt, .xsb and .sok file in it
+//
+// Levels with the most boxes, then the most floor, are started first, so the long searches are not the ones left
+// running on one core at the end. Every record has the file, level, status (solved, unsolvable, timeout, memory
+// or invalid), boxes, pushes, moves, nodes expanded and generated, and milliseconds. ida never reports memory, its
+// table is sized up front and a search that runs long is a timeout.
+//
+// Exits with 1 if any level could not be solved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/levelPack.h"
+#include "core/patternDatabase.h"
+#include "core/solver.h"
+
+using std::cout, std::endl, std::string;
+
+namespace {
+    struct Job {
+        string file;
+        int id;
+        bool valid;
+        Level level;
+        int boxes, floor;
+    };
+
+    // every level of a maps file, levels that do not parse as invalid jobs
+    void readLevels(const string &path, std::vector<Job> &jobs) {
+        std::vector<Level> levels;
+        std::vector<int> invalid;
+        if (!loadLevels(path, levels, &invalid))
+            return;
+        for (const Level &level : levels)
+            jobs.push_back({path, level.id, true, level, level.boxes.count(), level.cellCount() - level.walls.count()});
+        for (int id : invalid)
+            jobs.push_back({path, id, false, Level(), 0, 0});
+    }
+
+    // the level files named on the command line, directories replaced by the level files in them
+    std::vector<string> levelFiles(const std::vector<string> &paths) {
+        namespace fs = std::filesystem;
+        std::vector<string> files;
+        for (const string &path : paths) {
+            std::error_code error;
+            if (!fs::is_directory(path, error)) {
+                files.push_back(path);
+                continue;
+            }
+            std::vector<string> inside;
+            for (const auto &entry : fs::directory_iterator(path, error)) {
+                const string extension = entry.path().extension().string();
+                if (entry.is_regular_file() && (extension == ".txt" || formatOf(extension) == LevelFormat::Xsb))
+                    inside.push_back(entry.path().string());
+            }
+            std::sort(inside.begin(), inside.end());
+            files.insert(files.end(), inside.begin(), inside.end());
+        }
+        return files;
+    }
+
+    string csvField(const string &text) {
+        if (text.find_first_of(",\"\n") == string::npos)
+            return text;
+        string quoted = "\"";
+        for (char c : text) {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + '"';
+    }
+
+    string jsonString(const string &text) {
+        string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                quoted += '\\';
+            quoted += c;
+        }
+        return quoted + '"';
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string patternsPath = "../res/deadlocks.skpd";
+    string outPath;
+    bool json = false;
+    int jobCount = 0;
+    SolverOptions options;
+    options.algorithm = SolverAlgorithm::AStar;
+    options.timeLimit = 60;
+    options.memoryLimitMb = 512;
+    std::vector<string> paths;
+
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc) {
+            const string name = argv[++i];
+            if (name == "astar") {
+                options.algorithm = SolverAlgorithm::AStar;
+            } else if (name == "bfs") {
+                options.algorithm = SolverAlgorithm::Bfs;
+            } else if (name == "bidir") {
+                options.algorithm = SolverAlgorithm::Bidirectional;
+            } else if (name == "ida") {
+                options.algorithm = SolverAlgorithm::IdaStar;
+            } else {
+                // the parallel search is left out on purpose, the batch already gives every core its own level
+                cout << "unknown algorithm " << name << endl;
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--weight") == 0 && i + 1 < argc) {
+            options.weight = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            options.timeLimit = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc) {
+            options.memoryLimitMb = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            const string name = argv[++i];
+            if (name != "csv" && name != "json") {
+                cout << "unknown format " << name << endl;
+                return 2;
+            }
+            json = name == "json";
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--patterns") == 0 && i + 1 < argc) {
+            patternsPath = argv[++i];
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            paths.clear();
+            break;
+        }
+    }
+    if (paths.empty()) {
+        cout << "usage: sokoban-batch [--algorithm astar|bfs|bidir|ida] [--weight <w>] [--jobs <n>] [--time-limit <s>]"
+                " [--memory-mb <n>] [--format csv|json] [--out <file>] [--patterns <file>] <file|directory>..."
+             << endl;
+        return 2;
+    }
+    if (jobCount <= 0)
+        jobCount = (int)std::max(1u, std::thread::hardware_concurrency());
+    // IDA* stores no states, its memory is the table
+    if (options.algorithm == SolverAlgorithm::IdaStar)
+        options.tableMegabytes = options.memoryLimitMb / 4;
+    if (outPath.empty())
+        outPath = json ? "batch.json" : "batch.csv";
+    deadlockPatterns().open(patternsPath);
+
+    std::vector<Job> jobs;
+    for (const string &file : levelFiles(paths))
+        readLevels(file, jobs);
+    // biggest first: box count drives the size of the search, floor breaks ties
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job &a, const Job &b) {
+        return a.boxes != b.boxes ? a.boxes > b.boxes : a.floor > b.floor;
+    });
+
+    std::ofstream out(outPath);
+    if (!out) {
+        cout << "could not write " << outPath << endl;
+        return 2;
+    }
+    out << (json ? "[" : "file,level,status,boxes,pushes,moves,expanded,generated,ms\n") << std::flush;
+
+    std::mutex outputMutex;
+    size_t written = 0, solved = 0;
+    auto report = [&](const Job &job, const string &status, const SolverResult &result) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if (json) {
+            out << (written ? ",\n  " : "\n  ") << "{\"file\": " << jsonString(job.file) << ", \"level\": " << job.id
+                << ", \"status\": \"" << status << "\", \"boxes\": " << job.boxes << ", \"pushes\": "
+                << result.pushes.size() << ", \"moves\": " << result.moves.size() << ", \"expanded\": "
+                << result.expanded << ", \"generated\": " << result.generated << ", \"ms\": "
+                << result.milliseconds << "}";
+        } else {
+            out << csvField(job.file) << ',' << job.id << ',' << status << ',' << job.boxes << ','
+                << result.pushes.size() << ',' << result.moves.size() << ',' << result.expanded << ','
+                << result.generated << ',' << result.milliseconds << '\n';
+        }
+        out << std::flush;
+        ++written;
+        solved += result.solved;
+        cout << "[" << written << "/" << jobs.size() << "] " << job.file << " level " << job.id << ": " << status
+             << " (" << result.milliseconds << " ms)" << endl;
+    };
+
+    // a search that stopped on the state limit ran out of memory rather than time
+    const size_t stateLimit = SearchBudget(options).states();
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next {0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            const Job &job = jobs[i];
+            if (!job.valid) {
+                report(job, "invalid", SolverResult());
+                continue;
+            }
+            const SolverResult result = solve(job.level, options);
+            string status = "timeout";
+            if (result.solved)
+                status = "solved";
+            else if (result.unsolvable)
+                status = "unsolvable";
+            else if (stateLimit > 0 && result.generated >= stateLimit &&
+                     options.algorithm != SolverAlgorithm::IdaStar) // its memory is the table, fixed up front
+                status = "memory";
+            report(job, status, result);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t {0}; t < jobCount; ++t)
+        pool.emplace_back(worker);
+    for (std::thread &thread : pool)
+        thread.join();
+
+    if (json)
+        out << (written ? "\n]\n" : "]\n");
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cout << "solved " << solved << " of " << jobs.size() << " levels in " << seconds << " s with " << jobCount
+         << " threads, report in " << outPath << endl;
+    return solved == jobs.size() ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// sokoban-difficulty: scores how hard the levels of a pack are and stores the scores in the difficulty cache the
+// game reads for its level select screen.
+//
+// usage: sokoban-difficulty [--maps <file>] [--cache <file>] [--time-limit <s>] [--threads <n>]
+//   --maps        level file (default ../res/maps.txt)
+//   --cache       difficulty cache to read and update (default ../res/difficulty.cache)
+//   --time-limit  seconds of search per level (default 2)
+//   --threads     levels estimated at once (default: one per hardware thread)
+//
+// Levels already in the cache (by a hash of their contents) are not estimated again; levels not solved within the
+// time limit are not cached, since that depends on the machine. Prints every level, easiest first.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/difficulty.h"
+#include "core/patternDatabase.h"
+
+using std::cout, std::endl, std::string;
+
+int main(int argc, char *argv[]) {
+    string mapsPath = "../res/maps.txt";
+    string cachePath = "../res/difficulty.cache";
+    double seconds = 2;
+    int threads = 0;
+
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--maps") == 0 && i + 1 < argc) {
+            mapsPath = argv[++i];
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if (strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            cout << "usage: sokoban-difficulty [--maps <file>] [--cache <file>] [--time-limit <s>] [--threads <n>]"
+                 << endl;
+            return 2;
+        }
+    }
+    deadlockPatterns().open("../res/deadlocks.skpd");
+
+    std::vector<Level> levels;
+    if (!loadLevels(mapsPath, levels))
+        return 1;
+    DifficultyCache cache;
+    if (!cache.load(cachePath))
+        return 1;
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<Difficulty> difficulties = estimateDifficulties(levels, cache, seconds, threads);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<size_t> order(levels.size());
+    for (size_t i {0}; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return difficulties[a].score < difficulties[b].score; });
+    for (size_t i : order) {
+        const Difficulty &d = difficulties[i];
+        cout << "level " << levels[i].id << ": " << d.score << " (" << tierName(difficultyTier(d)) << "), ";
+        if (d.solved)
+            cout << d.pushes << " pushes, ";
+        else
+            cout << "not solved, ";
+        cout << d.expanded << " nodes, branching " << d.branching << ", traps " << 100 * d.traps << "%" << endl;
+    }
+    cout << levels.size() << " levels in " << elapsed << " s" << endl;
+    if (cache.changed() && !cache.save(cachePath))
+        return 1;
+    return 0;
+}
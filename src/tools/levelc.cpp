@@ -0,0 +1,113 @@
+// sokoban-levelc: compiles a text level pack into the binary format the game and the tools map into memory.
+//
+// usage: sokoban-levelc [--out <file>] <pack>
+//   --out   compiled pack to write (default: the pack with its extension replaced by .sklp)
+//   <pack>  level file in the res/maps.txt or XSB format
+//
+// The size, hash and modification time of the source go into the header, the game only uses the compiled pack while
+// the size and hash match (the time spares it reading the source to check).
+// Levels that do not load (no player, too large, bad characters) and repeated level numbers are reported and left
+// out. The compiled pack is read back and every level compared with its source before the tool reports success.
+// Exits with 1 if the pack could not be compiled or does not read back identically.
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "core/compiledPack.h"
+#include "core/levelPack.h"
+
+using std::cout, std::endl, std::string;
+
+namespace {
+    bool sameLevel(const Level &a, const Level &b) {
+        return a.id == b.id && a.rows == b.rows && a.cols == b.cols && a.width == b.width && a.height == b.height &&
+               a.playerStart == b.playerStart && a.goalEntrance == b.goalEntrance && a.walls == b.walls &&
+               a.targets == b.targets && a.boxes == b.boxes && a.dead == b.dead && a.tunnels[0] == b.tunnels[0] &&
+               a.tunnels[1] == b.tunnels[1] && a.goalRoom == b.goalRoom;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string inPath, outPath;
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (argv[i][0] != '-' && inPath.empty()) {
+            inPath = argv[i];
+        } else {
+            cout << "usage: sokoban-levelc [--out <file>] <pack>" << endl;
+            return 2;
+        }
+    }
+    if (inPath.empty()) {
+        cout << "usage: sokoban-levelc [--out <file>] <pack>" << endl;
+        return 2;
+    }
+    if (outPath.empty()) {
+        const size_t dot = inPath.find_last_of('.');
+        const size_t slash = inPath.find_last_of("/\\");
+        outPath = (dot == string::npos || (slash != string::npos && dot < slash) ? inPath : inPath.substr(0, dot))
+                  + ".sklp";
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    LevelPack source;
+    if (!source.open(inPath))
+        return 1;
+    if (source.format() == LevelFormat::Compiled) {
+        cout << inPath << " is already compiled" << endl;
+        return 2;
+    }
+    std::vector<Level> levels;
+    std::vector<string> titles;
+    std::unordered_set<int> ids;
+    int skipped = 0;
+    for (int i {0}; i < source.size(); ++i) {
+        Level level;
+        if (!source.load(i, level)) {
+            ++skipped;
+            continue;
+        }
+        if (!ids.insert(level.id).second) {
+            cout << "level " << level.id << " (line " << source.line(i) << ") repeats a level number, left out"
+                 << endl;
+            ++skipped;
+            continue;
+        }
+        levels.push_back(level);
+        titles.push_back(source.title(i));
+    }
+    // the header records the source, so the game can tell when the pack no longer matches it
+    if (!CompiledPack::write(outPath, levels, titles, inPath))
+        return 1;
+    const double compileMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // read it back the way the game does
+    const auto readStart = std::chrono::steady_clock::now();
+    LevelPack compiled;
+    if (!compiled.open(outPath) || compiled.size() != (int)levels.size()) {
+        cout << outPath << " does not read back" << endl;
+        return 1;
+    }
+    int mismatched = 0;
+    for (const Level &level : levels) {
+        Level loaded;
+        if (!compiled.loadId(level.id, loaded) || !sameLevel(level, loaded)) {
+            cout << "level " << level.id << " does not read back identically" << endl;
+            ++mismatched;
+        }
+    }
+    const double readMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+
+    cout << outPath << ": " << levels.size() << " levels";
+    if (skipped > 0)
+        cout << " (" << skipped << " left out)";
+    cout << ", compiled in " << compileMs << " ms, every level read back in " << readMs << " ms" << endl;
+    return mismatched == 0 ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+// sokoban-patterns: learns deadlock patterns from the walls of a level pack and writes a pattern database.
+//
+// usage: sokoban-patterns [--maps <file>] [--window <n>] [--boxes <n>] [--out <file>]
+//   --maps     level file whose walls are scanned (default ../res/maps.txt)
+//   --window   side of the square window, 2 to 5 (default 4)
+//   --boxes    most boxes per pattern (default 4)
+//   --out      database to write (default ../res/deadlocks.skpd)
+//
+// Every window of every level that holds no target is tried with every placement of up to --boxes boxes on its
+// floor. A placement is a deadlock if, with the window surrounded by open floor and the player starting anywhere,
+// its boxes can never all be pushed out of the window. Windows with the same walls are only solved once.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/deadlock.h"
+#include "core/levelPack.h"
+#include "core/patternDatabase.h"
+#include "core/search.h"
+#include "core/zobrist.h"
+
+using std::cout, std::endl, std::string;
+
+namespace {
+    // a placement that needs more states than this is not reported as a deadlock
+    const size_t MAX_STATES = 100000;
+
+    // The window on its own: its cells surrounded by a ring of floor targets. A box pushed onto the ring has left
+    // the window and is taken off the board.
+    Level windowLevel(const Level &level, int top, int left, int size) {
+        Level window;
+        window.rows = window.cols = size + 2;
+        window.width = window.height = size + 4;
+        for (int cell {0}; cell < window.cellCount(); ++cell)
+            window.walls.set(cell);
+        for (int row {0}; row < window.rows; ++row) {
+            for (int col {0}; col < window.cols; ++col) {
+                const int cell = window.cell(row, col);
+                if (row == 0 || col == 0 || row == size + 1 || col == size + 1) {
+                    window.walls.reset(cell);
+                    window.targets.set(cell);
+                } else if (!level.isWall((top + row - 1) * level.width + left + col - 1)) {
+                    window.walls.reset(cell);
+                }
+            }
+        }
+        window.playerStart = window.cell(0, 0);
+        window.dead = deadSquares(window);
+        return window;
+    }
+
+    struct WindowState {
+        Bitboard boxes;
+        uint64_t hash;
+        int player;
+
+        bool operator==(const WindowState &other) const {
+            return player == other.player && boxes == other.boxes;
+        }
+    };
+
+    struct WindowStateHash {
+        size_t operator()(const WindowState &state) const { return (size_t)state.hash; }
+    };
+
+    // true if every box can be pushed out of the window with the player starting next to player
+    bool canClear(const Level &window, const Bitboard &boxes, int player) {
+        std::vector<WindowState> states;
+        std::unordered_set<WindowState, WindowStateHash> seen;
+        auto add = [&](const Bitboard &stateBoxes, int from) {
+            const int normalized = normalizedPlayer(window, stateBoxes, from);
+            WindowState state {stateBoxes, zobristHash(stateBoxes, normalized), normalized};
+            if (seen.insert(state).second)
+                states.push_back(state);
+        };
+        add(boxes, player);
+        for (size_t next {0}; next < states.size(); ++next) {
+            if (states.size() > MAX_STATES)
+                return true;
+            const WindowState state = states[next];
+            bool cleared = false;
+            forEachPush(window, state.boxes, reachable(window, state.boxes, state.player), [&](const Push &push) {
+                const int to = push.box + window.offset(push.dir);
+                if (cleared || window.isDead(to))
+                    return;
+                Bitboard child = state.boxes;
+                child.reset(push.box);
+                if (!window.isTarget(to)) {
+                    child.set(to);
+                    if (isFreezeDeadlock(window, child, to))
+                        return;
+                }
+                cleared = child.none();
+                if (!cleared)
+                    add(child, push.box);
+            });
+            if (cleared)
+                return true;
+        }
+        return false;
+    }
+
+    // the player could be in any region the boxes leave open, a deadlock has to hold for all of them
+    bool isWindowDeadlock(const Level &window, const Bitboard &boxes) {
+        Bitboard tried = window.walls | boxes;
+        for (int cell {0}; cell < window.cellCount(); ++cell) {
+            if (tried.test(cell))
+                continue;
+            tried |= reachable(window, boxes, cell);
+            if (canClear(window, boxes, cell))
+                return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string mapsPath = "../res/maps.txt";
+    string outPath = "../res/deadlocks.skpd";
+    int size = 4;
+    int maxBoxes = 4;
+
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--maps") == 0 && i + 1 < argc) {
+            mapsPath = argv[++i];
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--boxes") == 0 && i + 1 < argc) {
+            maxBoxes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            cout << "usage: sokoban-patterns [--maps <file>] [--window <n>] [--boxes <n>] [--out <file>]" << endl;
+            return 2;
+        }
+    }
+    if (size < 2 || size > 5 || maxBoxes < 1) {
+        cout << "the window must be 2 to 5 cells wide and hold at least one box" << endl;
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    // every placement solved so far, by key: true if it is a deadlock
+    std::unordered_map<uint64_t, bool> known;
+    std::vector<uint64_t> deadlocks;
+    size_t windows = 0, solved = 0;
+
+    LevelPack pack;
+    if (!pack.open(mapsPath))
+        return 1;
+    for (int index {0}; index < pack.size(); ++index) {
+        Level level;
+        if (!pack.load(index, level))
+            continue;
+        for (int top {0}; top + size <= level.height; ++top) {
+            for (int left {0}; left + size <= level.width; ++left) {
+                std::vector<int> floor;
+                bool hasTarget = false;
+                for (int row = top; row < top + size; ++row) {
+                    for (int col = left; col < left + size; ++col) {
+                        const int cell = row * level.width + col;
+                        hasTarget = hasTarget || level.isTarget(cell);
+                        if (!level.isWall(cell))
+                            floor.push_back(cell);
+                    }
+                }
+                if (hasTarget || floor.empty())
+                    continue;
+                ++windows;
+                const Level window = windowLevel(level, top, left, size);
+                auto windowCell = [&](int cell) {
+                    return window.cell(cell / level.width - top + 1, cell % level.width - left + 1);
+                };
+
+                // placements by increasing box count, so every placement with one box less is already known
+                for (int count {1}; count <= maxBoxes && count <= (int)floor.size(); ++count) {
+                    std::vector<int> pick(count);
+                    for (int i {0}; i < count; ++i)
+                        pick[i] = i;
+                    while (true) {
+                        Bitboard boxes, windowBoxes;
+                        for (int i : pick) {
+                            boxes.set(floor[i]);
+                            windowBoxes.set(windowCell(floor[i]));
+                        }
+                        const uint64_t key = PatternDatabase::windowKey(level, boxes, top, left, size);
+                        if (known.find(key) == known.end()) {
+                            // adding a box never helps the others out
+                            bool deadlock = false;
+                            for (int i : pick) {
+                                Bitboard fewer = boxes;
+                                fewer.reset(floor[i]);
+                                auto smaller = known.find(PatternDatabase::windowKey(level, fewer, top, left, size));
+                                deadlock = deadlock || (smaller != known.end() && smaller->second);
+                            }
+                            if (!deadlock) {
+                                deadlock = isWindowDeadlock(window, windowBoxes);
+                                ++solved;
+                            }
+                            known[key] = deadlock;
+                            if (deadlock)
+                                deadlocks.push_back(key);
+                        }
+
+                        // next combination
+                        int i = count - 1;
+                        while (i >= 0 && pick[i] == (int)floor.size() - count + i)
+                            --i;
+                        if (i < 0)
+                            break;
+                        ++pick[i];
+                        for (int j = i + 1; j < count; ++j)
+                            pick[j] = pick[j - 1] + 1;
+                    }
+                }
+            }
+        }
+    }
+
+    if (!PatternDatabase::write(outPath, size, deadlocks))
+        return 1;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cout << windows << " windows, " << known.size() << " placements (" << solved << " searched), "
+         << deadlocks.size() << " deadlock patterns written to " << outPath << " in " << seconds << " s" << endl;
+    return 0;
+}
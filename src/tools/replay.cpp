@@ -0,0 +1,99 @@
+// sokoban-replay: plays recorded sessions back without a window and reports the outcome.
+//
+// usage: sokoban-replay [--maps <file>] [--repeat <n>] [--board] [--cycles] <replay>...
+//   --maps    level file the replays refer to (default ../res/maps.txt)
+//   --repeat  play every replay n times, for throughput measurements
+//   --board   print the final position of every replay
+//   --cycles  count moves that return to a position seen before (Zobrist hash of every position)
+//
+// Exits with 1 if any replay is invalid or does not solve its level.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/levelPack.h"
+#include "core/replay.h"
+
+using std::cout, std::endl, std::string;
+
+int main(int argc, char *argv[]) {
+    string mapsPath = "../res/maps.txt";
+    int repeat = 1;
+    bool printBoard = false;
+    bool detectCycles = false;
+    std::vector<string> files;
+
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--maps") == 0 && i + 1 < argc) {
+            mapsPath = argv[++i];
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--board") == 0) {
+            printBoard = true;
+        } else if (strcmp(argv[i], "--cycles") == 0) {
+            detectCycles = true;
+        } else if (argv[i][0] == '-') {
+            cout << "usage: sokoban-replay [--maps <file>] [--repeat <n>] [--board] [--cycles] <replay>..." << endl;
+            return 2;
+        } else {
+            files.emplace_back(argv[i]);
+        }
+    }
+
+    LevelPack pack;
+    if (!pack.open(mapsPath))
+        return 1;
+    std::map<int, Level> levels; // many replays usually share a level
+    bool allSolved = true;
+    size_t totalMoves = 0;
+    double totalSeconds = 0;
+
+    for (const string &file : files) {
+        Replay replay;
+        if (!loadReplay(file, replay)) {
+            allSolved = false;
+            continue;
+        }
+        auto found = levels.find(replay.level);
+        if (found == levels.end()) {
+            Level level;
+            if (!pack.loadId(replay.level, level)) {
+                allSolved = false;
+                continue;
+            }
+            found = levels.emplace(replay.level, level).first;
+        }
+
+        ReplayResult result;
+        auto start = std::chrono::steady_clock::now();
+        for (int r {0}; r < repeat; ++r)
+            result = runReplay(found->second, replay, detectCycles);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        totalMoves += replay.moves.size() * repeat;
+        totalSeconds += seconds;
+
+        cout << file << ": level " << replay.level
+             << ", " << result.moves << " moves, " << result.pushes << " pushes, "
+             << (result.solved ? "solved" : "not solved");
+        if (!result.valid)
+            cout << ", illegal move " << result.failedAt + 1 << " '" << replay.moves[result.failedAt] << "'";
+        if (detectCycles && result.revisits > 0)
+            cout << ", " << result.revisits << " revisited positions (first at move " << result.firstRevisit + 1 << ")";
+        cout << ", " << seconds * 1000.0 / repeat << " ms" << endl;
+        if (printBoard)
+            cout << boardToText(found->second, result.boxes, result.player);
+
+        allSolved = allSolved && result.valid && result.solved;
+    }
+
+    if (totalSeconds > 0)
+        cout << totalMoves << " moves in " << totalSeconds * 1000.0 << " ms ("
+             << totalMoves / totalSeconds / 1e6 << " M moves/s)" << endl;
+    return allSolved ? 0 : 1;
+}
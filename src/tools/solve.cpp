@@ -0,0 +1,250 @@
+// sokoban-solve: finds a solution for levels in the res/maps.txt or XSB format and prints it with search statistics.
+//
+// usage: sokoban-solve [--maps <file>] [--algorithm bfs|astar|ida|parallel|bidir] [--weight <w>]
+//                      [--macros|--no-macros] [--threads <n>] [--scaling] [--table-mb <n>]
+//                      [--replace shallower|always|never] [--time-limit <s>] [--states <n>] [--patterns <file>]
+//                      [--reach-benchmark] [<level>...]
+//   --maps        level file (default ../res/maps.txt)
+//   --algorithm   astar (default), bfs, ida (iterative deepening A*, little memory), parallel (multi-threaded
+//                 bfs) or bidir (bfs from both ends), all push-optimal unless bfs is given --macros
+//   --weight      A* heuristic weight, above 1 trades solution length for speed
+//   --macros      push boxes through tunnels and into the goal room as single macro moves (bfs, astar and ida). On
+//                 by default for astar only, since bfs then finds the fewest macro moves rather than the fewest
+//                 pushes; --no-macros turns them off for astar too
+//   --threads     threads for the parallel search (default: one per hardware thread)
+//   --scaling     parallel search: also solve with 1, 2, 4, ... threads and print the speedup of each run
+//   --table-mb    parallel search and ida: megabytes for the transposition table (default 64 for the parallel
+//                 search, 16 for ida, where 0 runs without one)
+//   --replace     parallel search and ida: which entry a full table bucket gives up, shallower (default, the deepest if
+//                 it is deeper than the new state), always (the deepest) or never (the new state is not recorded)
+//   --time-limit  give up on a level after this many seconds
+//   --states      give up on a level after storing this many states
+//   --patterns    deadlock pattern database (default ../res/deadlocks.skpd, skipped if missing)
+//   --reach-benchmark  instead of solving, time player reachability on positions from random pushes, the
+//                 bit-parallel flood fill against the queue-based search
+//   <level>       level numbers to solve (default: every level in the file)
+//
+// Exits with 1 if any level could not be solved.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/levelPack.h"
+#include "core/patternDatabase.h"
+#include "core/solver.h"
+
+using std::cout, std::endl, std::string;
+
+namespace {
+    // Positions met along random push sequences from the start, timed with both reachability functions. Returns
+    // false if they ever disagree.
+    bool benchmarkReachability(const Level &level) {
+        std::mt19937 random(level.id);
+        std::vector<std::pair<Bitboard, int>> positions;
+        Bitboard boxes = level.boxes;
+        int player = level.playerStart;
+        while (positions.size() < 4096) {
+            positions.push_back({boxes, player});
+            std::vector<Push> pushes;
+            forEachPush(level, boxes, reachableScalar(level, boxes, player), [&](const Push &push) {
+                pushes.push_back(push);
+            });
+            // start over now and then, and when stuck, so the positions are not all late in a long sequence
+            if (pushes.empty() || random() % 32 == 0) {
+                boxes = level.boxes;
+                player = level.playerStart;
+                continue;
+            }
+            const Push push = pushes[random() % pushes.size()];
+            boxes.move(push.box, push.box + level.offset(push.dir));
+            player = push.box;
+        }
+        for (const auto &position : positions) {
+            if (reachable(level, position.first, position.second) !=
+                reachableScalar(level, position.first, position.second)) {
+                cout << "level " << level.id << ": bit-parallel reachability differs from the scalar search" << endl;
+                return false;
+            }
+        }
+
+        auto nanoseconds = [&](Bitboard (*fill)(const Level &, const Bitboard &, int)) {
+            const int rounds = 50;
+            uint64_t checksum = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int round {0}; round < rounds; ++round) {
+                for (const auto &position : positions)
+                    checksum += fill(level, position.first, position.second).words[1];
+            }
+            const double elapsed = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count();
+            // the checksum keeps the calls from being optimized away
+            return checksum == 1 ? 0 : elapsed / (rounds * positions.size());
+        };
+        const double scalar = nanoseconds(reachableScalar);
+        const double parallel = nanoseconds(reachable);
+        cout << "level " << level.id << ": scalar " << scalar << " ns, bit-parallel " << parallel << " ns, speedup "
+             << scalar / parallel << endl;
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string mapsPath = "../res/maps.txt";
+    string patternsPath = "../res/deadlocks.skpd";
+    // A* with macro moves solves every shipped level, plain BFS gives up on levels 2 and 4 (see the README)
+    SolverOptions options;
+    options.algorithm = SolverAlgorithm::AStar;
+    int macros = -1; // -1 until --macros or --no-macros picks, then on for A* only
+    bool tableGiven = false;
+    std::vector<int> ids;
+    bool scaling = false;
+    bool reachBenchmark = false;
+
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--maps") == 0 && i + 1 < argc) {
+            mapsPath = argv[++i];
+        } else if (strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "bfs") {
+                options.algorithm = SolverAlgorithm::Bfs;
+            } else if (name == "astar") {
+                options.algorithm = SolverAlgorithm::AStar;
+            } else if (name == "parallel") {
+                options.algorithm = SolverAlgorithm::ParallelBfs;
+            } else if (name == "bidir") {
+                options.algorithm = SolverAlgorithm::Bidirectional;
+            } else if (name == "ida") {
+                options.algorithm = SolverAlgorithm::IdaStar;
+            } else {
+                cout << "unknown algorithm " << name << endl;
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--weight") == 0 && i + 1 < argc) {
+            options.weight = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--macros") == 0) {
+            macros = 1;
+        } else if (strcmp(argv[i], "--no-macros") == 0) {
+            macros = 0;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scaling") == 0) {
+            scaling = true;
+        } else if (strcmp(argv[i], "--table-mb") == 0 && i + 1 < argc) {
+            options.tableMegabytes = strtoull(argv[++i], nullptr, 10);
+            tableGiven = true;
+        } else if (strcmp(argv[i], "--replace") == 0 && i + 1 < argc) {
+            const std::string name = argv[++i];
+            if (name == "shallower") {
+                options.replacement = ReplacementPolicy::Shallower;
+            } else if (name == "always") {
+                options.replacement = ReplacementPolicy::Always;
+            } else if (name == "never") {
+                options.replacement = ReplacementPolicy::Never;
+            } else {
+                cout << "unknown replacement policy " << name << endl;
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            options.timeLimit = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--states") == 0 && i + 1 < argc) {
+            options.stateLimit = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--patterns") == 0 && i + 1 < argc) {
+            patternsPath = argv[++i];
+        } else if (strcmp(argv[i], "--reach-benchmark") == 0) {
+            reachBenchmark = true;
+        } else if (isdigit(static_cast<unsigned char>(argv[i][0]))) {
+            ids.push_back(atoi(argv[i]));
+        } else {
+            cout << "usage: sokoban-solve [--maps <file>] [--algorithm bfs|astar|ida|parallel|bidir] [--weight <w>]"
+                    " [--macros|--no-macros] [--threads <n>] [--scaling] [--table-mb <n>]"
+                    " [--replace shallower|always|never] [--time-limit <s>] [--states <n>] [--patterns <file>]"
+                    " [--reach-benchmark] [<level>...]" << endl;
+            return 2;
+        }
+    }
+    options.macros = macros < 0 ? options.algorithm == SolverAlgorithm::AStar : macros == 1;
+    // IDA* is the low-memory search, a small table already removes most repeated work
+    if (!tableGiven && options.algorithm == SolverAlgorithm::IdaStar)
+        options.tableMegabytes = 16;
+    LevelPack pack;
+    if (!pack.open(mapsPath))
+        return 1;
+    if (ids.empty()) {
+        for (int i {0}; i < pack.size(); ++i)
+            ids.push_back(pack.id(i));
+    }
+    if (options.threads <= 0)
+        options.threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    deadlockPatterns().open(patternsPath);
+
+    bool allSolved = true;
+    for (int id : ids) {
+        Level level;
+        if (!pack.loadId(id, level)) {
+            allSolved = false;
+            continue;
+        }
+        if (reachBenchmark) {
+            allSolved = benchmarkReachability(level) && allSolved;
+            continue;
+        }
+        SolverResult result = solve(level, options);
+
+        cout << "level " << id << ": ";
+        if (result.solved)
+            cout << "solved in " << result.pushes.size() << " pushes, " << result.moves.size() << " moves" << endl;
+        else if (result.unsolvable)
+            cout << "no solution" << endl;
+        else
+            cout << "gave up" << endl;
+        cout << "  nodes expanded " << result.expanded << ", generated " << result.generated
+             << ", " << result.milliseconds << " ms, process peak memory " << result.peakMemoryKb / 1024.0
+             << " MB (+" << result.peakGrowthKb / 1024.0 << " MB by this level)" << endl;
+        if (result.milliseconds > 0)
+            cout << "  " << (uint64_t)(result.expanded / (result.milliseconds / 1000.0)) << " nodes/s";
+        if (result.heuristicCalls > 0)
+            cout << ", heuristic " << result.heuristicMilliseconds * 1e6 / result.heuristicCalls << " ns/node ("
+                 << 100.0 * result.heuristicMilliseconds / result.milliseconds << "% of the time)";
+        cout << endl;
+        if (result.tableEntries > 0)
+            cout << "  table " << result.tableEntries << " entries (" << options.tableMegabytes << " MB), "
+                 << result.tableFailedInserts << " failed inserts" << endl;
+        if (!result.iterationNodes.empty()) {
+            cout << "  " << result.iterationNodes.size() << " iterations, nodes per iteration";
+            for (uint64_t nodes : result.iterationNodes)
+                cout << " " << nodes;
+            cout << endl;
+        }
+        if (result.solved && options.algorithm == SolverAlgorithm::Bidirectional)
+            cout << "  searches met " << result.forwardDepth << " pushes from the start, " << result.backwardDepth
+                 << " from the goal" << endl;
+        if (result.solved)
+            cout << "  " << result.moves << endl;
+
+        allSolved = allSolved && result.solved;
+
+        if (scaling && options.algorithm == SolverAlgorithm::ParallelBfs) {
+            // thread counts 1, 2, 4, ... and the requested count, speedup relative to one thread
+            SolverOptions single = options;
+            double baseline = 0;
+            for (int threads {1};; threads = std::min(threads * 2, options.threads)) {
+                single.threads = threads;
+                const SolverResult run = solve(level, single);
+                if (threads == 1)
+                    baseline = run.milliseconds;
+                cout << "  " << threads << " threads: " << run.milliseconds << " ms, speedup "
+                     << (run.milliseconds > 0 ? baseline / run.milliseconds : 0) << endl;
+                if (threads == options.threads)
+                    break;
+            }
+        }
+    }
+    return allSolved ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// sokoban-validate: checks every level of one or more level packs on all cores and prints compiler-style
+// diagnostics ("file:line:column: error: ...") for the problems it finds.
+//
+// usage: sokoban-validate [--jobs <n>] [--time-limit <s>] [--memory-mb <n>] [--no-solve] [--patterns <file>]
+//                         <pack>...
+//   --jobs        levels checked at once (default: one per hardware thread)
+//   --time-limit  seconds of search per level for the solvability check (default 5)
+//   --memory-mb   megabytes of search states per level (default 256)
+//   --no-solve    structural checks only
+//   --patterns    deadlock pattern database (default ../res/deadlocks.skpd, skipped if missing)
+//   <pack>        a level file in the res/maps.txt or XSB format
+//
+// The structural checks are those of checkLevel(): legend, one player, as many boxes as targets, closed walls,
+// boxes and targets the player can get to, size, boxes on dead squares. Levels that pass are then solved with A*
+// (macro moves on): a level proven unsolvable is an error, one not solved within the budget a warning. Level
+// numbers used twice in a pack are errors as well. Exits with 1 if there are errors.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/levelCheck.h"
+#include "core/levelPack.h"
+#include "core/patternDatabase.h"
+#include "core/solver.h"
+
+using std::cout, std::endl, std::string;
+
+namespace {
+    struct Job {
+        size_t pack;
+        int index;
+        std::vector<Diagnostic> diagnostics;
+        bool solved;
+    };
+}
+
+int main(int argc, char *argv[]) {
+    string patternsPath = "../res/deadlocks.skpd";
+    int jobCount = 0;
+    bool solveLevels = true;
+    SolverOptions options;
+    options.algorithm = SolverAlgorithm::AStar;
+    options.macros = true;
+    options.timeLimit = 5;
+    options.memoryLimitMb = 256;
+    std::vector<string> paths;
+
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            options.timeLimit = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc) {
+            options.memoryLimitMb = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--no-solve") == 0) {
+            solveLevels = false;
+        } else if (strcmp(argv[i], "--patterns") == 0 && i + 1 < argc) {
+            patternsPath = argv[++i];
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            paths.clear();
+            break;
+        }
+    }
+    if (paths.empty()) {
+        cout << "usage: sokoban-validate [--jobs <n>] [--time-limit <s>] [--memory-mb <n>] [--no-solve]"
+                " [--patterns <file>] <pack>..." << endl;
+        return 2;
+    }
+    if (jobCount <= 0)
+        jobCount = (int)std::max(1u, std::thread::hardware_concurrency());
+    deadlockPatterns().open(patternsPath);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<LevelPack>> packs;
+    std::vector<string> packPaths;
+    std::vector<Job> jobs;
+    bool unreadable = false;
+    for (const string &path : paths) {
+        auto pack = std::make_unique<LevelPack>();
+        if (!pack->open(path)) {
+            unreadable = true;
+            continue;
+        }
+        if (pack->format() == LevelFormat::Compiled) {
+            cout << path << ": compiled packs have no text to check, validate the pack they were compiled from"
+                 << endl;
+            unreadable = true;
+            continue;
+        }
+        // a level number used twice: loading by number only ever finds the first
+        std::unordered_map<int, int> firstLine;
+        for (int i {0}; i < pack->size(); ++i) {
+            jobs.push_back({packs.size(), i, {}, false});
+            auto first = firstLine.emplace(pack->id(i), pack->line(i));
+            if (!first.second) {
+                jobs.back().diagnostics.push_back(
+                    {pack->line(i), 0, true,
+                     "level number used before, at line " + std::to_string(first.first->second)});
+            }
+        }
+        packs.push_back(std::move(pack));
+        packPaths.push_back(path);
+    }
+
+    std::atomic<size_t> next {0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            Job &job = jobs[i];
+            const LevelPack &pack = *packs[job.pack];
+            Level level;
+            bool loaded;
+            std::vector<Diagnostic> found = checkLevel(pack, job.index, level, loaded);
+            job.diagnostics.insert(job.diagnostics.end(), found.begin(), found.end());
+            const bool fine = std::none_of(found.begin(), found.end(), [](const Diagnostic &d) { return d.error; });
+            if (!solveLevels || !loaded || !fine)
+                continue;
+            const SolverResult result = solve(level, options);
+            job.solved = result.solved;
+            if (result.unsolvable)
+                job.diagnostics.push_back({pack.line(job.index), 0, true, "the level has no solution"});
+            else if (!result.solved)
+                job.diagnostics.push_back({pack.line(job.index), 0, false,
+                                           "not solved within " + std::to_string((int)options.timeLimit) + " s"});
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t {0}; t < jobCount; ++t)
+        pool.emplace_back(worker);
+    for (std::thread &thread : pool)
+        thread.join();
+
+    size_t errors = 0, warnings = 0, solved = 0, bad = 0;
+    for (const Job &job : jobs) {
+        const LevelPack &pack = *packs[job.pack];
+        bool levelError = false;
+        for (const Diagnostic &d : job.diagnostics) {
+            cout << packPaths[job.pack] << ":" << d.line;
+            if (d.column > 0)
+                cout << ":" << d.column;
+            cout << ": " << (d.error ? "error" : "warning") << ": level " << pack.id(job.index) << ": " << d.message
+                 << endl;
+            (d.error ? errors : warnings) += 1;
+            levelError = levelError || d.error;
+        }
+        solved += job.solved;
+        bad += levelError;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cout << jobs.size() << " levels, " << bad << " with errors (" << errors << " errors, " << warnings
+         << " warnings)";
+    if (solveLevels)
+        cout << ", " << solved << " solved";
+    cout << ", in " << seconds << " s with " << jobCount << " threads" << endl;
+    return errors > 0 || unreadable ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+// Checks LevelPack::reload() against indexing the edited text from scratch.
+//
+// usage: sokoban-test-levelpack [--edits <n>] [<pack>...]
+//   --edits  random edits per pack (default 500)
+//   <pack>   level files to edit, in the res/maps.txt or XSB format (default: a small built-in XSB pack only)
+//
+// Each edit replaces a random span of a pack with a random span of the same pack (or nothing), which edits, adds,
+// removes, merges and renumbers levels. After every edit the reloaded pack must index exactly like a fresh
+// openText() of the new text, and the ids reload() reports as changed must cover every level that was edited, added
+// or removed. Exits with 1 on the first mismatch.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/levelPack.h"
+
+using std::cout, std::endl, std::string, std::vector;
+
+namespace {
+    const char *XSB_PACK =
+        "; built-in pack\n"
+        "\n"
+        "Title: One\n"
+        "#####\n"
+        "#@$.#\n"
+        "#####\n"
+        "\n"
+        "Title: Two\n"
+        "######\n"
+        "#@ $.#\n"
+        "#  $.#\n"
+        "######\n"
+        "\n"
+        "#######\n"
+        "#.$@$.#\n"
+        "#######\n"
+        "\n"
+        "Title: Four\n"
+        "  ####\n"
+        "###  #\n"
+        "#.$@ #\n"
+        "######\n";
+
+    bool readFile(const string &path, string &text) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool writeFile(const string &path, const string &text) {
+        std::ofstream out(path, std::ios::binary);
+        out << text;
+        return (bool)out;
+    }
+
+    // the same levels, with the same titles, lines and text, in the same order
+    bool sameIndex(const LevelPack &a, const LevelPack &b) {
+        if (a.size() != b.size())
+            return false;
+        for (int i {0}; i < a.size(); ++i) {
+            if (a.id(i) != b.id(i) || a.title(i) != b.title(i) || a.line(i) != b.line(i) || a.text(i) != b.text(i) ||
+                a.find(b.id(i)) != b.find(b.id(i)))
+                return false;
+        }
+        return true;
+    }
+
+    // the first id that differs between before and after (edited, added or removed) and is not in changed, -1 if none
+    int missedChange(const LevelPack &before, const LevelPack &after, const vector<int> &changed) {
+        auto reported = [&](int id) { return std::find(changed.begin(), changed.end(), id) != changed.end(); };
+        for (int i {0}; i < after.size(); ++i) {
+            const int old = before.find(after.id(i));
+            if ((old < 0 || before.text(old) != after.text(i) || before.title(old) != after.title(i)) &&
+                !reported(after.id(i)))
+                return after.id(i);
+        }
+        for (int i {0}; i < before.size(); ++i) {
+            if (after.find(before.id(i)) < 0 && !reported(before.id(i)))
+                return before.id(i);
+        }
+        return -1;
+    }
+
+    // edits the pack in a file named like name (its extension picks the format), false on the first mismatch
+    bool checkReloads(const string &name, const string &base, int edits, std::mt19937 &random) {
+        const string path = (std::filesystem::temp_directory_path() / ("sokoban-test-" + name)).string();
+        bool passed = true;
+        for (int edit {0}; edit < edits && passed; ++edit) {
+            if (!writeFile(path, base)) {
+                cout << "could not write " << path << endl;
+                return false;
+            }
+            LevelPack reloaded, before;
+            reloaded.open(path);
+            before.open(path);
+
+            string text = base;
+            const size_t at = random() % (text.size() + 1);
+            const size_t length = std::min<size_t>(random() % 200, text.size() - at);
+            const size_t from = random() % (text.size() + 1);
+            string inserted = random() % 3 == 0 ? string() : text.substr(from, random() % 300);
+            text.replace(at, length, inserted);
+            writeFile(path, text);
+
+            vector<int> changed;
+            LevelPack fresh;
+            fresh.openText(text, reloaded.format());
+            if (!reloaded.reload(changed)) {
+                cout << name << ", edit " << edit << ": reload() could not read the pack" << endl;
+                passed = false;
+            } else if (!sameIndex(reloaded, fresh)) {
+                cout << name << ", edit " << edit << ": reloaded pack differs from a fresh one (" << length
+                     << " bytes at " << at << " replaced by " << inserted.size() << ")" << endl;
+                passed = false;
+            } else if (const int missed = missedChange(before, fresh, changed); missed >= 0) {
+                cout << name << ", edit " << edit << ": level " << missed << " changed but was not reported" << endl;
+                passed = false;
+            }
+        }
+        std::filesystem::remove(path);
+        return passed;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int edits = 500;
+    vector<string> packs;
+    for (int i {1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--edits") == 0 && i + 1 < argc) {
+            edits = std::max(1, atoi(argv[++i]));
+        } else if (argv[i][0] != '-') {
+            packs.push_back(argv[i]);
+        } else {
+            cout << "usage: sokoban-test-levelpack [--edits <n>] [<pack>...]" << endl;
+            return 2;
+        }
+    }
+
+    std::mt19937 random(7); // fixed, so a failure repeats
+    bool passed = checkReloads("builtin.xsb", XSB_PACK, edits, random);
+    for (const string &pack : packs) {
+        string text;
+        if (!readFile(pack, text)) {
+            cout << "could not read " << pack << endl;
+            return 1;
+        }
+        const string name = std::filesystem::path(pack).filename().string();
+        passed = checkReloads(name, text, edits, random) && passed;
+    }
+    cout << (passed ? "passed" : "failed") << endl;
+    return passed ? 0 : 1;
+}